@@ -1,18 +1,357 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LIST_AVX2_DISPATCH 1
+#else
+#define LIST_AVX2_DISPATCH 0
+#endif
+
 template<typename T>
 class List {
 public:
+    class NodePool;
+    struct Tower;
+
     struct Node {
         T data;
         Node *next;
         Node *prev;
+        NodePool *owner;
+        Tower *tower;
+    };
+
+    // Slab-backed node storage. Released nodes are kept on a free list linked
+    // through their next pointers, so a whole chain goes back in O(1) when T
+    // needs no destructor. Every node remembers the pool it came from, so
+    // splice relinks between any two lists and a node is later returned to
+    // its own pool: directly by lists on that pool, through a lock-free
+    // remote stack by everyone else. The pool lives until its last list lets
+    // go of it and every node it handed out has come back. Apart from the
+    // remote stack a pool is not thread-safe; lists sharing one must stay on
+    // one thread.
+    class NodePool {
+        struct alignas(Node) Slot {
+            unsigned char bytes[sizeof(Node)];
+        };
+
+        static constexpr size_t firstSlabSize = 64;
+        static constexpr size_t maxSlabSize = 1 << 16;
+
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        Slot *cursor = nullptr;
+        Slot *slabEnd = nullptr;
+        size_t nextSlabSize = firstSlabSize;
+        Node *freeHead = nullptr;
+        // Nodes handed out minus those returned by lists on this pool.
+        std::ptrdiff_t live = 0;
+        std::atomic<Node *> remoteHead{nullptr};
+        // Minus the nodes returned remotely; once the lists let go, live is
+        // added in and whoever brings it to zero deletes the pool.
+        std::atomic<std::ptrdiff_t> debt{0};
+
+        NodePool() = default;
+
+        struct Retire {
+            void operator()(NodePool *pool) const noexcept {
+                std::ptrdiff_t outstanding = pool->live;
+                if (pool->debt.fetch_add(outstanding, std::memory_order_acq_rel) + outstanding == 0) {
+                    delete pool;
+                }
+            }
+        };
+
+        void pushFree(Node *first, Node *last) noexcept {
+            last->next = freeHead;
+            freeHead = first;
+        }
+
+    public:
+        NodePool(const NodePool &) = delete;
+        NodePool &operator=(const NodePool &) = delete;
+
+        static std::shared_ptr<NodePool> make() {
+            return std::shared_ptr<NodePool>(new NodePool, Retire{});
+        }
+
+        template<typename... Args>
+        Node *create(Node *next, Node *prev, Args &&...args) {
+            if (freeHead == nullptr && remoteHead.load(std::memory_order_relaxed) != nullptr) {
+                freeHead = remoteHead.exchange(nullptr, std::memory_order_acquire);
+            }
+            void *storage;
+            if (freeHead != nullptr) {
+                storage = freeHead;
+                freeHead = freeHead->next;
+            } else {
+                if (cursor == slabEnd) {
+                    slabs.emplace_back(new Slot[nextSlabSize]);
+                    cursor = slabs.back().get();
+                    slabEnd = cursor + nextSlabSize;
+                    nextSlabSize = std::min(nextSlabSize * 2, maxSlabSize);
+                }
+                storage = cursor++;
+            }
+            Node *node;
+            try {
+                node = ::new (storage) Node{T(std::forward<Args>(args)...), next, prev, this, nullptr};
+            } catch (...) {
+                node = static_cast<Node *>(storage);
+                pushFree(node, node);
+                throw;
+            }
+            ++live;
+            return node;
+        }
+
+        static void destroyData(Node *first, Node *last) noexcept {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (Node *node = first;; node = node->next) {
+                    node->data.~T();
+                    if (node == last) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Releases the chain first..last (linked through next) of count
+        // nodes, all from this pool; only lists on this pool may call it.
+        void destroy(Node *first, Node *last, size_t count) noexcept {
+            destroyData(first, last);
+            pushFree(first, last);
+            live -= static_cast<std::ptrdiff_t>(count);
+        }
+
+        // As destroy, from a list on another pool and possibly another thread.
+        void giveBack(Node *first, Node *last, size_t count) noexcept {
+            destroyData(first, last);
+            Node *expected = remoteHead.load(std::memory_order_relaxed);
+            do {
+                last->next = expected;
+            } while (!remoteHead.compare_exchange_weak(expected, first, std::memory_order_release, std::memory_order_relaxed));
+            std::ptrdiff_t returned = static_cast<std::ptrdiff_t>(count);
+            if (debt.fetch_sub(returned, std::memory_order_acq_rel) == returned) {
+                delete this;
+            }
+        }
+    };
+
+    // A node's levels in the skip index, allocated in one block with the
+    // links stored right behind the header.
+    struct Tower {
+        struct Link {
+            Tower *next;
+            Tower *prev;
+        };
+        Node *node;
+        size_t height;
+
+        Link *links() { return reinterpret_cast<Link *>(this + 1); }
+        const Link *links() const { return reinterpret_cast<const Link *>(this + 1); }
+
+        static Tower *make(Node *node, size_t height) {
+            Tower *tower = ::new (::operator new(sizeof(Tower) + height * sizeof(Link))) Tower{node, height};
+            std::uninitialized_fill_n(tower->links(), height, Link{nullptr, nullptr});
+            return tower;
+        }
+        static void free(Tower *tower) noexcept { ::operator delete(tower); }
+    };
+
+    // Optional skip-list levels over the list's nodes. Towers are linked by
+    // position only, so the index stays consistent under any insert, erase or
+    // splice; lower_bound is O(log n) expected while the list is kept sorted.
+    // Each indexed node points at its tower, so inserting and erasing never
+    // look a node up.
+    class SkipIndex {
+        static constexpr size_t maxLevel = 24;
+        using Link = typename Tower::Link;
+
+        Tower *top;
+        size_t levels = 0;
+        std::minstd_rand rng;
+
+        size_t randomHeight() {
+            size_t height = 0;
+            while (height < maxLevel && (rng() & 3) == 0) {
+                ++height;
+            }
+            return height;
+        }
+
+    public:
+        SkipIndex() : top(Tower::make(nullptr, maxLevel)) {}
+        SkipIndex(const SkipIndex &) = delete;
+        SkipIndex &operator=(const SkipIndex &) = delete;
+        ~SkipIndex() {
+            clear();
+            Tower::free(top);
+        }
+
+        // Every tower sits on level 0, so one walk there frees them all.
+        void clear() {
+            for (Tower *tower = top->links()[0].next; tower != nullptr;) {
+                Tower *next = tower->links()[0].next;
+                tower->node->tower = nullptr;
+                Tower::free(tower);
+                tower = next;
+            }
+            std::fill_n(top->links(), maxLevel, Link{nullptr, nullptr});
+            levels = 0;
+        }
+
+        // Call after node has been linked into the list.
+        void onInsert(Node *node) {
+            size_t height = randomHeight();
+            if (height == 0) {
+                return;
+            }
+            Tower *tower = Tower::make(node, height);
+            Tower *pred = top;
+            for (Node *walk = node->prev; walk != nullptr; walk = walk->prev) {
+                if (walk->tower != nullptr) {
+                    pred = walk->tower;
+                    break;
+                }
+            }
+            for (size_t level = 0; level < height; ++level) {
+                while (pred->height <= level) {
+                    pred = pred->links()[level - 1].prev;
+                }
+                Tower *next = pred->links()[level].next;
+                tower->links()[level] = {next, pred};
+                if (next != nullptr) {
+                    next->links()[level].prev = tower;
+                }
+                pred->links()[level].next = tower;
+            }
+            levels = std::max(levels, height);
+            node->tower = tower;
+        }
+
+        // Call before node is unlinked from the list.
+        void onErase(Node *node) {
+            Tower *tower = node->tower;
+            if (tower == nullptr) {
+                return;
+            }
+            for (size_t level = 0; level < tower->height; ++level) {
+                auto [next, prev] = tower->links()[level];
+                prev->links()[level].next = next;
+                if (next != nullptr) {
+                    next->links()[level].prev = prev;
+                }
+            }
+            node->tower = nullptr;
+            Tower::free(tower);
+        }
+
+        // Last indexed node whose value is less than value, or nullptr.
+        template<typename U>
+        Node *lastBelow(const U &value) const {
+            const Tower *tower = top;
+            for (size_t level = levels; level-- > 0;) {
+                while (tower->links()[level].next != nullptr && tower->links()[level].next->node->data < value) {
+                    tower = tower->links()[level].next;
+                }
+            }
+            return tower->node;
+        }
     };
 
     Node *head;
     Node *tail;
     size_t size_;
+    std::shared_ptr<NodePool> pool;
+    std::unique_ptr<SkipIndex> index;
+    // Set once the list holds nodes spliced in from another pool.
+    bool mixed = false;
+
+    NodePool &nodes() {
+        if (!pool) {
+            pool = NodePool::make();
+        }
+        return *pool;
+    }
+
+    // Returns the chain first..last of count nodes to the pools they came from.
+    void release(Node *first, Node *last, size_t count) noexcept {
+        if (!mixed) {
+            pool->destroy(first, last, count);
+            return;
+        }
+        for (;;) {
+            NodePool *owner = first->owner;
+            Node *runEnd = first;
+            size_t run = 1;
+            while (runEnd != last && runEnd->next->owner == owner) {
+                runEnd = runEnd->next;
+                ++run;
+            }
+            Node *rest = runEnd != last ? runEnd->next : nullptr;
+            if (owner == pool.get()) {
+                owner->destroy(first, runEnd, run);
+            } else {
+                owner->giveBack(first, runEnd, run);
+            }
+            if (rest == nullptr) {
+                return;
+            }
+            first = rest;
+        }
+    }
+
+    bool sharesPoolWith(const List &other) const {
+        return pool != nullptr && pool == other.pool;
+    }
+
+    void swapContents(List &other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size_, other.size_);
+        std::swap(pool, other.pool);
+        std::swap(index, other.index);
+        std::swap(mixed, other.mixed);
+    }
+
+    void indexRange(Node* first, Node* last) {
+        for (Node* node = first;; node = node->next) {
+            index->onInsert(node);
+            if (node == last) {
+                break;
+            }
+        }
+    }
+
+    // Links the detached chain first..last in front of pos (nullptr = end).
+    void linkBefore(Node* pos, Node* first, Node* last) {
+        Node* prevNode = pos != nullptr ? pos->prev : tail;
+        if (prevNode != nullptr) {
+            prevNode->next = first;
+        } else {
+            head = first;
+        }
+        first->prev = prevNode;
+        last->next = pos;
+        if (pos != nullptr) {
+            pos->prev = last;
+        } else {
+            tail = last;
+        }
+    }
 
 public:
     class iterator {
@@ -55,6 +394,7 @@ public:
     };
 
     List() : head(nullptr), tail(nullptr), size_(0) {}
+    explicit List(std::shared_ptr<NodePool> sharedPool) : head(nullptr), tail(nullptr), size_(0), pool(std::move(sharedPool)) {}
     List(size_t count, const T &value = T()) : head(nullptr), tail(nullptr), size_(0) {
         for (size_t i = 0; i < count; ++i) {
             push_back(value);
@@ -65,10 +405,11 @@ public:
             push_back(value);
         }
     }
-    explicit List(List &&other) : head(other.head), tail(other.tail), size_(other.size_) {
+    explicit List(List &&other) : head(other.head), tail(other.tail), size_(other.size_), pool(std::move(other.pool)), index(std::move(other.index)), mixed(other.mixed) {
         other.head = nullptr;
         other.tail = nullptr;
         other.size_ = 0;
+        other.mixed = false;
     }
     List(std::initializer_list<T> ilist) : head(nullptr), tail(nullptr), size_(0) {
         for (const T &value : ilist) {
@@ -77,9 +418,16 @@ public:
     }
 
     void clear() {
-        while (!empty()) {
-            pop_front();
+        if (index) {
+            index->clear();
+        }
+        if (head != nullptr) {
+            release(head, tail, size_);
         }
+        head = nullptr;
+        tail = nullptr;
+        size_ = 0;
+        mixed = false;
     }
 
     ~List() {
@@ -89,18 +437,14 @@ public:
     List &operator=(const List &other) {
         if (this != &other) {
             List temp(other);
-            std::swap(head, temp.head);
-            std::swap(tail, temp.tail);
-            std::swap(size_, temp.size_);
+            swapContents(temp);
         }
         return *this;
     }
     List &operator=(List &&other) {
         if (this != &other) {
             clear();
-            std::swap(head, other.head);
-            std::swap(tail, other.tail);
-            std::swap(size_, other.size_);
+            swapContents(other);
         }
         return *this;
     }
@@ -120,14 +464,44 @@ public:
     bool empty() const { return size_ == 0; }
     std::size_t size() const { return size_; }
 
+    std::shared_ptr<NodePool> node_pool() {
+        nodes();
+        return pool;
+    }
+
+    // The index is not copied with the list; copies start unindexed.
+    void build_index() {
+        index = std::make_unique<SkipIndex>();
+        if (head != nullptr) {
+            indexRange(head, tail);
+        }
+    }
+    void drop_index() { index.reset(); }
+    bool has_index() const { return index != nullptr; }
+
+    // First element not less than value; expected O(log n) with an index on a
+    // sorted list, a linear scan otherwise.
+    template<typename U>
+    iterator lower_bound(const U &value) const {
+        Node *node = head;
+        if (index) {
+            Node *below = index->lastBelow(value);
+            if (below != nullptr) {
+                node = below->next;
+            }
+        }
+        while (node != nullptr && node->data < value) {
+            node = node->next;
+        }
+        return iterator(node);
+    }
+
     iterator insert(iterator pos, const T &value) {
-        Node *node = new Node{value, nullptr, nullptr};
         if (pos.current == nullptr) {
             push_back(value);
             return iterator(tail);
         }
-        node->next = pos.current;
-        node->prev = pos.current->prev;
+        Node *node = nodes().create(pos.current, pos.current->prev, value);
         if (pos.current->prev != nullptr) {
             pos.current->prev->next = node;
         } else {
@@ -135,16 +509,17 @@ public:
         }
         pos.current->prev = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
         return iterator(node);
     }
     iterator insert(iterator pos, T &&value) {
-        Node *node = new Node{std::move(value), nullptr, nullptr};
         if (pos.current == nullptr) {
             push_back(std::move(value));
             return iterator(tail);
         }
-        node->next = pos.current;
-        node->prev = pos.current->prev;
+        Node *node = nodes().create(pos.current, pos.current->prev, std::move(value));
         if (pos.current->prev != nullptr) {
             pos.current->prev->next = node;
         } else {
@@ -152,6 +527,9 @@ public:
         }
         pos.current->prev = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
         return iterator(node);
     }
     iterator insert(iterator pos, std::initializer_list<T> ilist) {
@@ -168,6 +546,9 @@ public:
         }
         Node *node = pos.current;
         iterator next(node->next);
+        if (index) {
+            index->onErase(node);
+        }
         if (node->prev != nullptr) {
             node->prev->next = node->next;
         } else {
@@ -178,19 +559,44 @@ public:
         } else {
             tail = node->prev;
         }
-        delete node;
+        release(node, node, 1);
         --size_;
         return next;
     }
     iterator erase(iterator first, iterator last) {
-        while (first != last) {
-            first = erase(first);
+        if (first == last) {
+            return last;
+        }
+        Node *firstNode = first.current;
+        Node *lastNode = firstNode;
+        size_t count = 1;
+        if (index) {
+            index->onErase(firstNode);
+        }
+        while (lastNode->next != last.current) {
+            lastNode = lastNode->next;
+            ++count;
+            if (index) {
+                index->onErase(lastNode);
+            }
         }
+        if (firstNode->prev != nullptr) {
+            firstNode->prev->next = last.current;
+        } else {
+            head = last.current;
+        }
+        if (last.current != nullptr) {
+            last.current->prev = firstNode->prev;
+        } else {
+            tail = firstNode->prev;
+        }
+        release(firstNode, lastNode, count);
+        size_ -= count;
         return last;
     }
 
     void push_front(const T &value) {
-        Node *node = new Node{value, head, nullptr};
+        Node *node = nodes().create(head, nullptr, value);
         if (head != nullptr) {
             head->prev = node;
         } else {
@@ -198,9 +604,12 @@ public:
         }
         head = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
     }
     void push_front(T &&value) {
-        Node *node = new Node{std::move(value), head, nullptr};
+        Node *node = nodes().create(head, nullptr, std::move(value));
         if (head != nullptr) {
             head->prev = node;
         } else {
@@ -208,9 +617,12 @@ public:
         }
         head = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
     }
     void push_back(const T &value) {
-        Node *node = new Node{value, nullptr, tail};
+        Node *node = nodes().create(nullptr, tail, value);
         if (tail != nullptr) {
             tail->next = node;
         } else {
@@ -218,9 +630,12 @@ public:
         }
         tail = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
     }
     void push_back(T &&value) {
-        Node *node = new Node{std::move(value), nullptr, tail};
+        Node *node = nodes().create(nullptr, tail, std::move(value));
         if (tail != nullptr) {
             tail->next = node;
         } else {
@@ -228,6 +643,9 @@ public:
         }
         tail = node;
         ++size_;
+        if (index) {
+            index->onInsert(node);
+        }
     }
 
     void pop_front() {
@@ -235,13 +653,16 @@ public:
             return;
         }
         Node *node = head;
+        if (index) {
+            index->onErase(node);
+        }
         head = head->next;
         if (head != nullptr) {
             head->prev = nullptr;
         } else {
             tail = nullptr;
         }
-        delete node;
+        release(node, node, 1);
         --size_;
     }
 
@@ -252,31 +673,60 @@ public:
         if (this == &other) {
             return;
         }
-        Node* first = other.head;
-        Node* last = other.tail;
-        if (pos.current == nullptr) {
-            if (tail != nullptr) {
-                tail->next = first;
-            } else {
-                head = first;
-            }
-            first->prev = tail;
-            tail = last;
-        } else {
-            Node* prevNode = pos.current->prev;
-            if (prevNode != nullptr) {
-                prevNode->next = first;
-            } else {
-                head = first;
-            }
-            first->prev = prevNode;
-            pos.current->prev = last;
-            last->next = pos.current;
+        mixed = mixed || other.mixed || !sharesPoolWith(other);
+        if (other.index) {
+            other.index->clear();
+        }
+        linkBefore(pos.current, other.head, other.tail);
+        if (index) {
+            indexRange(other.head, other.tail);
         }
         size_ += other.size_;
         other.head = nullptr;
         other.tail = nullptr;
         other.size_ = 0;
+        other.mixed = false;
+    }
+    // Moves [first, last) of other before pos by relinking, whatever pools
+    // the two lists use; pos must not lie inside the range when other is
+    // this list.
+    void splice(iterator pos, List& other, iterator first, iterator last) {
+        if (first == last) {
+            return;
+        }
+        Node* firstNode = first.current;
+        Node* lastNode = last.current != nullptr ? last.current->prev : other.tail;
+        if (this != &other) {
+            size_t count = 1;
+            for (Node* node = firstNode; node != lastNode; node = node->next) {
+                ++count;
+            }
+            other.size_ -= count;
+            size_ += count;
+            mixed = mixed || other.mixed || !sharesPoolWith(other);
+        }
+        if (other.index) {
+            for (Node* node = firstNode;; node = node->next) {
+                other.index->onErase(node);
+                if (node == lastNode) {
+                    break;
+                }
+            }
+        }
+        if (firstNode->prev != nullptr) {
+            firstNode->prev->next = last.current;
+        } else {
+            other.head = last.current;
+        }
+        if (last.current != nullptr) {
+            last.current->prev = firstNode->prev;
+        } else {
+            other.tail = firstNode->prev;
+        }
+        linkBefore(pos.current, firstNode, lastNode);
+        if (index) {
+            indexRange(firstNode, lastNode);
+        }
     }
 
     void pop_back() {
@@ -284,13 +734,16 @@ public:
             return;
         }
         Node *node = tail;
+        if (index) {
+            index->onErase(node);
+        }
         tail = tail->prev;
         if (tail != nullptr) {
             tail->next = nullptr;
         } else {
             head = nullptr;
         }
-        delete node;
+        release(node, node, 1);
         --size_;
     }
 
@@ -315,114 +768,1176 @@ public:
 
 };
 
-//task 01
-template<typename T>
-void partitionLinkedList(List<T>& list, const T& x) {
-    List<T> less;
-    List<T> greaterOrEqual;
-    List<T> single{ x };
+// Doubly linked list of blocks holding up to K elements each, so scans touch
+// contiguous memory and follow one pointer per K elements. Iterators are
+// (block, index) pairs; end() sits one past the last element of the tail block.
+// erase leaves the block it touches at least K / 4 full (unless it is the
+// only block) by merging with or borrowing from a neighbour, so erasing
+// cannot strand a trail of nearly empty blocks.
+template<typename T, size_t K = 16>
+class UnrolledList {
+    static_assert(K >= 2, "UnrolledList needs at least two elements per block");
 
+    struct Block {
+        Block *next;
+        Block *prev;
+        size_t count;
+        alignas(T) unsigned char storage[K * sizeof(T)];
 
-    for (auto it = list.begin(); it != list.end();) {
-        auto next = it;
-        ++next;
-        if ( *it != x )
-        {
-            if (*it < x ) {
-                less.push_back(*it);
-            } else {
-                greaterOrEqual.push_back(*it);
-            }
+        Block(Block *nextBlock, Block *prevBlock) : next(nextBlock), prev(prevBlock), count(0) {}
+
+        T *items() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    Block *head;
+    Block *tail;
+    size_t size_;
+
+    template<typename U>
+    static void insertAt(Block *block, size_t index, U &&value) {
+        T *items = block->items();
+        if (index == block->count) {
+            ::new (items + index) T(std::forward<U>(value));
+        } else {
+            T temp(std::forward<U>(value));
+            ::new (items + block->count) T(std::move(items[block->count - 1]));
+            std::move_backward(items + index, items + block->count - 1, items + block->count);
+            items[index] = std::move(temp);
         }
+        ++block->count;
+    }
 
-        list.erase(it);
-        it = next;
+    static void eraseAt(Block *block, size_t index) {
+        T *items = block->items();
+        std::move(items + index + 1, items + block->count, items + index);
+        items[block->count - 1].~T();
+        --block->count;
     }
 
-    less.splice(less.end(), single);
-    less.splice(single.begin(), greaterOrEqual);
-    list = less;
-}
+    // Moves items [from, source->count) to the end of target.
+    static void moveTail(Block *source, size_t from, Block *target) {
+        T *src = source->items();
+        T *dst = target->items() + target->count;
+        for (size_t i = from; i < source->count; ++i) {
+            ::new (dst++) T(std::move(src[i]));
+            src[i].~T();
+        }
+        target->count += source->count - from;
+        source->count = from;
+    }
 
-//task 02
-void minorsToCapitals(List<char>& list)
-{
-    auto it = list.begin();
-    auto it2 = list.begin();
-    bool mut = false;
-    char last_char = '\0';
-
-    while (true) {
-        if (it == list.end() && mut) {
-            it = list.erase(it2, it);
-            list.insert(it, static_cast<char>(last_char - ('a' - 'A')));
-            break;
+    // Moves the last n items of source to the front of target.
+    static void moveToFront(Block *source, size_t n, Block *target) {
+        T *dst = target->items();
+        for (size_t i = target->count; i-- > 0;) {
+            ::new (dst + i + n) T(std::move(dst[i]));
+            dst[i].~T();
+        }
+        T *src = source->items() + source->count - n;
+        for (size_t i = 0; i < n; ++i) {
+            ::new (dst + i) T(std::move(src[i]));
+            src[i].~T();
         }
+        source->count -= n;
+        target->count += n;
+    }
 
-        if (it == list.end()) {
-            break;
+    // Moves the first n items of source to the back of target.
+    static void moveToBack(Block *source, size_t n, Block *target) {
+        T *src = source->items();
+        T *dst = target->items() + target->count;
+        for (size_t i = 0; i < n; ++i) {
+            ::new (dst + i) T(std::move(src[i]));
         }
+        std::move(src + n, src + source->count, src);
+        std::destroy(src + source->count - n, src + source->count);
+        source->count -= n;
+        target->count += n;
+    }
 
-        if (*it != last_char) {
-            if (mut) {
-                it = list.erase(it2, it);
-                list.insert(it, static_cast<char>(last_char - ('a' - 'A')));
-                it2 = it;
-                mut = false;
-            } else {
-                it2 = it;
-            }
+    Block *linkAfter(Block *block) {
+        Block *created = new Block(block != nullptr ? block->next : head, block);
+        if (created->next != nullptr) {
+            created->next->prev = created;
+        } else {
+            tail = created;
+        }
+        if (block != nullptr) {
+            block->next = created;
+        } else {
+            head = created;
         }
+        return created;
+    }
 
-        if (*it == last_char) {
-            mut = true;
+    void unlink(Block *block) {
+        if (block->prev != nullptr) {
+            block->prev->next = block->next;
+        } else {
+            head = block->next;
+        }
+        if (block->next != nullptr) {
+            block->next->prev = block->prev;
+        } else {
+            tail = block->prev;
         }
+        delete block;
+    }
 
-        last_char = *it;
-        ++it;
+    // Moves items [index, count) of block into a new block right after it.
+    Block *splitAt(Block *block, size_t index) {
+        Block *upper = linkAfter(block);
+        moveTail(block, index, upper);
+        return upper;
     }
-}
 
-//task 03
-template<typename InputIt, typename T>
-bool binarySearch(InputIt first, InputIt last, const T& value) {
-    if constexpr (std::is_same_v<typename std::iterator_traits<InputIt>::iterator_category, std::random_access_iterator_tag>) {
-        return std::binary_search(first, last, value);
-    } else {
-        for (; first != last; ++first) {
-            if (*first == value) {
-                return true;
-            } else if (*first > value) {
-                return false;
+public:
+    class iterator {
+        friend class UnrolledList;
+        Block *block;
+        size_t index;
+
+        iterator(Block *b, size_t i) : block(b), index(i) {}
+
+    public:
+        using value_type = T;
+        using reference = T &;
+        using pointer = T *;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iterator() : block(nullptr), index(0) {}
+        reference operator*() const { return block->items()[index]; }
+        pointer operator->() const { return block->items() + index; }
+        iterator &operator++() {
+            if (++index == block->count && block->next != nullptr) {
+                block = block->next;
+                index = 0;
             }
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        iterator &operator--() {
+            if (index == 0) {
+                block = block->prev;
+                index = block->count;
+            }
+            --index;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator temp = *this;
+            --(*this);
+            return temp;
+        }
+        friend bool operator==(iterator lhs, iterator rhs) {
+            return lhs.block == rhs.block && lhs.index == rhs.index;
+        }
+        friend bool operator!=(iterator lhs, iterator rhs) {
+            return !(lhs == rhs);
+        }
+    };
+
+    UnrolledList() : head(nullptr), tail(nullptr), size_(0) {}
+    UnrolledList(std::initializer_list<T> ilist) : UnrolledList() {
+        for (const T &value : ilist) {
+            push_back(value);
         }
-        return false;
     }
-}
+    UnrolledList(const UnrolledList &other) : UnrolledList() {
+        for (const T &value : other) {
+            push_back(value);
+        }
+    }
+    UnrolledList(UnrolledList &&other) noexcept : head(other.head), tail(other.tail), size_(other.size_) {
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size_ = 0;
+    }
+    ~UnrolledList() {
+        clear();
+    }
 
-int main()
-{
-    //task 01
-    List<int> list { 6, -2, 5, 4, 0, 3 };
-    partitionLinkedList(list, 4);
+    UnrolledList &operator=(UnrolledList other) {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size_, other.size_);
+        return *this;
+    }
 
-    for (const auto& value : list) {
-        std::cout << value << " ";
+    void clear() {
+        while (head != nullptr) {
+            Block *next = head->next;
+            std::destroy(head->items(), head->items() + head->count);
+            delete head;
+            head = next;
+        }
+        tail = nullptr;
+        size_ = 0;
     }
-    std::cout << std::endl;
 
-    //task 02
-    List<char> chList { 'a', 'a', 'b', 'c', 'c', 'c' };
-    minorsToCapitals(chList);
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
 
-    for ( auto it = chList.begin(); it != chList.end(); ++it)
-    {
-        std::cout << *it << " ";
-    }
+    T &front() { return head->items()[0]; }
+    T &back() { return tail->items()[tail->count - 1]; }
 
-    std::cout << std::endl;
+    iterator begin() const { return iterator(head, 0); }
+    iterator end() const { return iterator(tail, tail != nullptr ? tail->count : 0); }
 
-    //task 03
+    template<typename U>
+    iterator insert(iterator pos, U &&value) {
+        if (pos == end()) {
+            push_back(std::forward<U>(value));
+            return iterator(tail, tail->count - 1);
+        }
+        Block *block = pos.block;
+        size_t index = pos.index;
+        if (block->count == K) {
+            // value may refer to an element the split is about to move.
+            T item(std::forward<U>(value));
+            Block *upper = splitAt(block, K / 2);
+            if (index > K / 2) {
+                block = upper;
+                index -= K / 2;
+            }
+            insertAt(block, index, std::move(item));
+        } else {
+            insertAt(block, index, std::forward<U>(value));
+        }
+        ++size_;
+        return iterator(block, index);
+    }
+
+    iterator erase(iterator pos) {
+        Block *block = pos.block;
+        size_t index = pos.index;
+        eraseAt(block, index);
+        --size_;
+        if (block->count == 0) {
+            Block *next = block->next;
+            unlink(block);
+            return next != nullptr ? iterator(next, 0) : end();
+        }
+        if (block->count < K / 4) {
+            // Fold the block into a neighbour when both fit in one block,
+            // otherwise even it out with the fuller neighbour.
+            Block *prev = block->prev;
+            Block *next = block->next;
+            if (prev != nullptr && prev->count + block->count <= K) {
+                index += prev->count;
+                moveTail(block, 0, prev);
+                unlink(block);
+                block = prev;
+            } else if (next != nullptr && block->count + next->count <= K) {
+                moveTail(next, 0, block);
+                unlink(next);
+            } else if (prev != nullptr) {
+                const size_t n = (prev->count - block->count) / 2;
+                moveToFront(prev, n, block);
+                index += n;
+            } else if (next != nullptr) {
+                moveToBack(next, (next->count - block->count) / 2, block);
+            }
+        }
+        if (index == block->count && block->next != nullptr) {
+            return iterator(block->next, 0);
+        }
+        return iterator(block, index);
+    }
+    iterator erase(iterator first, iterator last) {
+        size_t count = std::distance(first, last);
+        while (count-- > 0) {
+            first = erase(first);
+        }
+        return first;
+    }
+
+    template<typename U>
+    void push_back(U &&value) {
+        if (tail == nullptr || tail->count == K) {
+            linkAfter(tail);
+        }
+        insertAt(tail, tail->count, std::forward<U>(value));
+        ++size_;
+    }
+    template<typename U>
+    void push_front(U &&value) {
+        if (head == nullptr || head->count == K) {
+            linkAfter(nullptr);
+        }
+        insertAt(head, 0, std::forward<U>(value));
+        ++size_;
+    }
+    void pop_front() {
+        erase(begin());
+    }
+    void pop_back() {
+        erase(iterator(tail, tail->count - 1));
+    }
+
+    // Moves all of other's elements before pos. Whole blocks are relinked; only
+    // the block containing pos is split, so the cost is O(K) regardless of size.
+    void splice(iterator pos, UnrolledList &other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        Block *before;
+        if (pos == end()) {
+            before = tail;
+        } else if (pos.index == 0) {
+            before = pos.block->prev;
+        } else {
+            splitAt(pos.block, pos.index);
+            before = pos.block;
+        }
+        Block *after = before != nullptr ? before->next : head;
+        other.head->prev = before;
+        other.tail->next = after;
+        if (before != nullptr) {
+            before->next = other.head;
+        } else {
+            head = other.head;
+        }
+        if (after != nullptr) {
+            after->prev = other.tail;
+        } else {
+            tail = other.tail;
+        }
+        size_ += other.size_;
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size_ = 0;
+    }
+
+    friend bool operator==(const UnrolledList &lhs, const UnrolledList &rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+};
+
+// Links embedded in a user type so an IntrusiveList can thread existing
+// objects without allocating. A type may carry several hooks to sit on
+// several lists at once.
+template<typename T>
+struct ListHook {
+    T *next = nullptr;
+    T *prev = nullptr;
+};
+
+// List over objects owned elsewhere, linked through the hook member Hook.
+// Same iterator, insert, erase and splice semantics as List, except that
+// erase only unlinks: the list never creates, copies or destroys objects.
+template<typename T, ListHook<T> T::*Hook>
+class IntrusiveList {
+    T *head;
+    T *tail;
+    size_t size_;
+
+    static ListHook<T> &hook(T *object) { return object->*Hook; }
+
+    void linkBefore(T *pos, T *first, T *last) {
+        T *prevObject = pos != nullptr ? hook(pos).prev : tail;
+        if (prevObject != nullptr) {
+            hook(prevObject).next = first;
+        } else {
+            head = first;
+        }
+        hook(first).prev = prevObject;
+        hook(last).next = pos;
+        if (pos != nullptr) {
+            hook(pos).prev = last;
+        } else {
+            tail = last;
+        }
+    }
+
+    void unlink(T *first, T *last) {
+        T *before = hook(first).prev;
+        T *after = hook(last).next;
+        if (before != nullptr) {
+            hook(before).next = after;
+        } else {
+            head = after;
+        }
+        if (after != nullptr) {
+            hook(after).prev = before;
+        } else {
+            tail = before;
+        }
+    }
+
+public:
+    class iterator {
+    public:
+        T *current;
+        using value_type = T;
+        using reference = T&;
+        using pointer = T*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iterator() : current(nullptr) {}
+        explicit iterator(T *object) : current(object) {}
+        reference operator*() const { return *current; }
+        pointer operator->() const { return current; }
+        iterator &operator++() {
+            current = hook(current).next;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+        iterator &operator--() {
+            current = hook(current).prev;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator temp = *this;
+            --(*this);
+            return temp;
+        }
+        friend bool operator==(iterator lhs, iterator rhs) {
+            return lhs.current == rhs.current;
+        }
+        friend bool operator!=(iterator lhs, iterator rhs) {
+            return lhs.current != rhs.current;
+        }
+    };
+
+    IntrusiveList() : head(nullptr), tail(nullptr), size_(0) {}
+    IntrusiveList(const IntrusiveList &) = delete;
+    IntrusiveList &operator=(const IntrusiveList &) = delete;
+    IntrusiveList(IntrusiveList &&other) : head(other.head), tail(other.tail), size_(other.size_) {
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size_ = 0;
+    }
+    IntrusiveList &operator=(IntrusiveList &&other) {
+        if (this != &other) {
+            clear();
+            std::swap(head, other.head);
+            std::swap(tail, other.tail);
+            std::swap(size_, other.size_);
+        }
+        return *this;
+    }
+    ~IntrusiveList() {
+        clear();
+    }
+
+    // Unlinks every object and resets its hook.
+    void clear() {
+        while (head != nullptr) {
+            T *next = hook(head).next;
+            hook(head) = ListHook<T>();
+            head = next;
+        }
+        tail = nullptr;
+        size_ = 0;
+    }
+
+    T &front() { return *head; }
+    T &back() { return *tail; }
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    iterator begin() const { return iterator(head); }
+    iterator end() const { return iterator(nullptr); }
+
+    // O(1) iterator for an object known to be on this list.
+    static iterator iterator_to(T &object) { return iterator(&object); }
+
+    iterator insert(iterator pos, T &object) {
+        linkBefore(pos.current, &object, &object);
+        ++size_;
+        return iterator(&object);
+    }
+    iterator erase(iterator pos) {
+        if (pos.current == nullptr) {
+            return pos;
+        }
+        T *object = pos.current;
+        iterator next(hook(object).next);
+        unlink(object, object);
+        hook(object) = ListHook<T>();
+        --size_;
+        return next;
+    }
+    iterator erase(iterator first, iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return last;
+    }
+
+    void push_front(T &object) { insert(begin(), object); }
+    void push_back(T &object) { insert(end(), object); }
+    void pop_front() { erase(begin()); }
+    void pop_back() { erase(iterator(tail)); }
+
+    void splice(iterator pos, IntrusiveList &other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        linkBefore(pos.current, other.head, other.tail);
+        size_ += other.size_;
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.size_ = 0;
+    }
+    // pos must not lie inside [first, last) when other is this list.
+    void splice(iterator pos, IntrusiveList &other, iterator first, iterator last) {
+        if (first == last) {
+            return;
+        }
+        T *firstObject = first.current;
+        T *lastObject = last.current != nullptr ? hook(last.current).prev : other.tail;
+        if (this != &other) {
+            size_t count = 1;
+            for (T *object = firstObject; object != lastObject; object = hook(object).next) {
+                ++count;
+            }
+            other.size_ -= count;
+            size_ += count;
+        }
+        other.unlink(firstObject, lastObject);
+        linkBefore(pos.current, firstObject, lastObject);
+    }
+};
+
+// Multi-producer multi-consumer deque (Michael's CAS-based deque): pushes
+// and pops at both ends never lock. Both end nodes live in one 64-bit anchor
+// together with a status recording a push whose old end node does not yet
+// link to the new one; a thread that finds the anchor in that state makes
+// the link before retrying, so the anchor is only ever stuck until some
+// thread finishes the push. Nodes are named by 31-bit indices into chunks
+// that double in size, which is what lets the anchor fit one word. Popped
+// nodes are reclaimed through epochs: every operation announces the epoch
+// it started in, and a node retired in epoch e is reused once every
+// announced epoch is past e, so no thread can still hold its index.
+template<typename T>
+class ConcurrentDeque {
+    struct Node {
+        std::optional<T> data;
+        std::atomic<uint32_t> left{0};
+        std::atomic<uint32_t> right{0};
+    };
+
+    static constexpr uint32_t none = 0;
+    static constexpr uint32_t indexMask = (uint32_t{1} << 31) - 1;
+
+    enum Status : uint64_t { stable, pushingRight, pushingLeft };
+
+    struct Anchor {
+        uint32_t left;
+        uint32_t right;
+        Status status;
+
+        uint64_t pack() const {
+            return left | uint64_t{right} << 31 | uint64_t{status} << 62;
+        }
+        static Anchor unpack(uint64_t bits) {
+            return {static_cast<uint32_t>(bits & indexMask), static_cast<uint32_t>(bits >> 31 & indexMask),
+                    static_cast<Status>(bits >> 62)};
+        }
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        uint32_t node;
+    };
+
+    static constexpr size_t readerSlots = 128;
+    static constexpr uint64_t idle = 0;
+    static constexpr size_t collectThreshold = 64;
+
+    // A slot belongs to one thread while it is announced; its retired and
+    // free lists travel with the slot and are only touched by the owner.
+    // collectAt doubles while a stalled reader keeps nodes visible, so the
+    // scans stay linear in the number of retirements.
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{idle};
+        std::vector<Retired> retired;
+        std::vector<uint32_t> free;
+        size_t collectAt = collectThreshold;
+    };
+
+    // Chunk k holds 2^(firstChunkBits + k) nodes; together they cover every
+    // index below 2^31.
+    static constexpr unsigned firstChunkBits = 10;
+    static constexpr size_t chunkCount = 31 - firstChunkBits + 1;
+
+    alignas(64) std::atomic<uint64_t> anchor{0};
+    alignas(64) std::atomic<uint32_t> nextIndex{1};
+    std::atomic<uint64_t> globalEpoch{1};
+    std::atomic<Node *> chunks[chunkCount]{};
+    ReaderSlot slots[readerSlots];
+
+    static unsigned floorLog2(uint64_t value) {
+#if defined(__GNUC__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned log = 0;
+        while (value >>= 1) {
+            ++log;
+        }
+        return log;
+#endif
+    }
+
+    Node &node(uint32_t index) {
+        const uint64_t position = uint64_t{index} - 1 + (uint64_t{1} << firstChunkBits);
+        const unsigned log = floorLog2(position);
+        return chunks[log - firstChunkBits].load()[position - (uint64_t{1} << log)];
+    }
+
+    void ensureChunk(uint32_t index) {
+        const uint64_t position = uint64_t{index} - 1 + (uint64_t{1} << firstChunkBits);
+        const unsigned log = floorLog2(position);
+        std::atomic<Node *> &chunk = chunks[log - firstChunkBits];
+        if (chunk.load() != nullptr) {
+            return;
+        }
+        Node *created = new Node[size_t{1} << log];
+        Node *expected = nullptr;
+        if (!chunk.compare_exchange_strong(expected, created)) {
+            delete[] created;
+        }
+    }
+
+    class Guard {
+        ConcurrentDeque &deque;
+        ReaderSlot *slot;
+
+    public:
+        explicit Guard(ConcurrentDeque &owner) : deque(owner) {
+            static thread_local size_t hint = 0;
+            for (size_t attempt = 0;; ++attempt) {
+                const size_t index = (hint + attempt) % readerSlots;
+                uint64_t expected = idle;
+                if (deque.slots[index].epoch.compare_exchange_strong(expected, deque.globalEpoch.load())) {
+                    hint = index;
+                    slot = &deque.slots[index];
+                    return;
+                }
+                if (attempt % readerSlots == readerSlots - 1) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+        ~Guard() {
+            slot->epoch.store(idle);
+        }
+
+        // An unused node index, recycled when possible.
+        uint32_t acquire() {
+            if (!slot->free.empty()) {
+                const uint32_t index = slot->free.back();
+                slot->free.pop_back();
+                return index;
+            }
+            const uint32_t index = deque.nextIndex.fetch_add(1);
+            if (index > indexMask) {
+                deque.nextIndex.fetch_sub(1);
+                throw std::length_error("ConcurrentDeque is full");
+            }
+            deque.ensureChunk(index);
+            return index;
+        }
+
+        // Returns a node that was never published.
+        void release(uint32_t index) {
+            slot->free.push_back(index);
+        }
+
+        void retire(uint32_t index) {
+            slot->retired.push_back({deque.globalEpoch.load(), index});
+            if (slot->retired.size() < slot->collectAt) {
+                return;
+            }
+            deque.globalEpoch.fetch_add(1);
+            uint64_t oldest = UINT64_MAX;
+            for (const ReaderSlot &other : deque.slots) {
+                const uint64_t announced = other.epoch.load();
+                if (announced != idle) {
+                    oldest = std::min(oldest, announced);
+                }
+            }
+            auto stillVisible = std::partition(slot->retired.begin(), slot->retired.end(),
+                                               [oldest](const Retired &entry) { return entry.epoch >= oldest; });
+            for (auto it = stillVisible; it != slot->retired.end(); ++it) {
+                slot->free.push_back(it->node);
+            }
+            slot->retired.erase(stillVisible, slot->retired.end());
+            slot->collectAt = std::max(collectThreshold, 2 * slot->retired.size());
+        }
+    };
+
+public:
+    ConcurrentDeque() = default;
+    ConcurrentDeque(const ConcurrentDeque &) = delete;
+    ConcurrentDeque &operator=(const ConcurrentDeque &) = delete;
+
+    // Not thread-safe: no other operation may be running.
+    ~ConcurrentDeque() {
+        for (std::atomic<Node *> &chunk : chunks) {
+            delete[] chunk.load();
+        }
+    }
+
+    void push_back(const T &value) { pushRight(value); }
+    void push_back(T &&value) { pushRight(std::move(value)); }
+    void push_front(const T &value) { pushLeft(value); }
+    void push_front(T &&value) { pushLeft(std::move(value)); }
+
+    std::optional<T> try_pop_back() {
+        Guard guard(*this);
+        while (true) {
+            const Anchor a = Anchor::unpack(anchor.load());
+            if (a.right == none) {
+                return std::nullopt;
+            }
+            if (a.right == a.left) {
+                if (replace(a, {none, none, stable})) {
+                    return take(guard, a.right);
+                }
+            } else if (a.status == stable) {
+                const uint32_t prev = node(a.right).left.load();
+                if (replace(a, {a.left, prev, stable})) {
+                    return take(guard, a.right);
+                }
+            } else {
+                stabilize(a);
+            }
+        }
+    }
+
+    std::optional<T> try_pop_front() {
+        Guard guard(*this);
+        while (true) {
+            const Anchor a = Anchor::unpack(anchor.load());
+            if (a.left == none) {
+                return std::nullopt;
+            }
+            if (a.left == a.right) {
+                if (replace(a, {none, none, stable})) {
+                    return take(guard, a.left);
+                }
+            } else if (a.status == stable) {
+                const uint32_t next = node(a.left).right.load();
+                if (replace(a, {next, a.right, stable})) {
+                    return take(guard, a.left);
+                }
+            } else {
+                stabilize(a);
+            }
+        }
+    }
+
+    // A momentary answer that may be stale by the time it is used.
+    bool empty() const {
+        return Anchor::unpack(anchor.load()).left == none;
+    }
+
+private:
+    bool replace(const Anchor &expected, const Anchor &desired) {
+        uint64_t bits = expected.pack();
+        return anchor.compare_exchange_strong(bits, desired.pack());
+    }
+
+    template<typename U>
+    uint32_t make(Guard &guard, U &&value) {
+        const uint32_t index = guard.acquire();
+        Node &created = node(index);
+        try {
+            created.data.emplace(std::forward<U>(value));
+        } catch (...) {
+            guard.release(index);
+            throw;
+        }
+        created.left.store(none);
+        created.right.store(none);
+        return index;
+    }
+
+    // Only the thread whose CAS removed the node touches its data.
+    std::optional<T> take(Guard &guard, uint32_t index) {
+        Node &taken = node(index);
+        std::optional<T> value(std::move(taken.data));
+        taken.data.reset();
+        guard.retire(index);
+        return value;
+    }
+
+    template<typename U>
+    void pushRight(U &&value) {
+        Guard guard(*this);
+        const uint32_t created = make(guard, std::forward<U>(value));
+        while (true) {
+            const Anchor a = Anchor::unpack(anchor.load());
+            if (a.right == none) {
+                if (replace(a, {created, created, stable})) {
+                    return;
+                }
+            } else if (a.status == stable) {
+                node(created).left.store(a.right);
+                const Anchor pushed{a.left, created, pushingRight};
+                if (replace(a, pushed)) {
+                    stabilizeRight(pushed);
+                    return;
+                }
+            } else {
+                stabilize(a);
+            }
+        }
+    }
+
+    template<typename U>
+    void pushLeft(U &&value) {
+        Guard guard(*this);
+        const uint32_t created = make(guard, std::forward<U>(value));
+        while (true) {
+            const Anchor a = Anchor::unpack(anchor.load());
+            if (a.left == none) {
+                if (replace(a, {created, created, stable})) {
+                    return;
+                }
+            } else if (a.status == stable) {
+                node(created).right.store(a.left);
+                const Anchor pushed{created, a.right, pushingLeft};
+                if (replace(a, pushed)) {
+                    stabilizeLeft(pushed);
+                    return;
+                }
+            } else {
+                stabilize(a);
+            }
+        }
+    }
+
+    void stabilize(const Anchor &a) {
+        if (a.status == pushingRight) {
+            stabilizeRight(a);
+        } else {
+            stabilizeLeft(a);
+        }
+    }
+
+    // Points the old right end at the new one, then marks the anchor stable.
+    // Every step rechecks the anchor so a stale helper changes nothing.
+    void stabilizeRight(const Anchor &a) {
+        const uint32_t prev = node(a.right).left.load();
+        if (anchor.load() != a.pack()) {
+            return;
+        }
+        uint32_t prevNext = node(prev).right.load();
+        if (prevNext != a.right) {
+            if (anchor.load() != a.pack()) {
+                return;
+            }
+            if (!node(prev).right.compare_exchange_strong(prevNext, a.right)) {
+                return;
+            }
+        }
+        replace(a, {a.left, a.right, stable});
+    }
+
+    void stabilizeLeft(const Anchor &a) {
+        const uint32_t next = node(a.left).right.load();
+        if (anchor.load() != a.pack()) {
+            return;
+        }
+        uint32_t nextPrev = node(next).left.load();
+        if (nextPrev != a.left) {
+            if (anchor.load() != a.pack()) {
+                return;
+            }
+            if (!node(next).left.compare_exchange_strong(nextPrev, a.left)) {
+                return;
+            }
+        }
+        replace(a, {a.left, a.right, stable});
+    }
+};
+
+//task 01
+// Stable partition around x by relinking: elements < x keep their place, runs
+// of elements > x are spliced out and re-attached after a single x. Duplicates
+// of x are dropped, and x is only allocated when the list does not contain it.
+template<typename T>
+void partitionLinkedList(List<T>& list, const T& x) {
+    List<T> greater(list.node_pool());
+    auto pivot = list.end();
+
+    for (auto it = list.begin(); it != list.end();) {
+        if (*it != x) {
+            if (*it < x) {
+                ++it;
+                continue;
+            }
+            auto runEnd = std::next(it);
+            while (runEnd != list.end() && *runEnd != x && !(*runEnd < x)) {
+                ++runEnd;
+            }
+            greater.splice(greater.end(), list, it, runEnd);
+            it = runEnd;
+        } else if (pivot == list.end()) {
+            pivot = it++;
+        } else {
+            it = list.erase(it);
+        }
+    }
+
+    if (pivot == list.end()) {
+        list.push_back(x);
+    } else {
+        list.splice(list.end(), list, pivot, std::next(pivot));
+    }
+    list.splice(list.end(), greater);
+}
+
+//task 02
+#if LIST_AVX2_DISPATCH
+inline bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+// Streaming engine behind minorsToCapitals: every run of two or more equal
+// chars collapses into one char shifted down by 'a' - 'A', single chars pass
+// through. The last char seen stays pending between feed() calls, so runs may
+// span chunk boundaries; finish() flushes it. Output never gets ahead of the
+// input, which makes in-place use safe.
+class RunLengthTransformer {
+    static constexpr char shift = 'a' - 'A';
+    static constexpr std::size_t blockSize = 32;
+    // Above this many run starts per block, walking the set bits costs more
+    // in mispredicted branches than a fixed pass over all 32 chars.
+    static constexpr int denseStarts = 8;
+
+    char pending = '\0';
+    bool pendingIsRun = false;
+    bool havePending = false;
+
+    // Written as a plain reduction so the compiler can vectorize it.
+    static bool blockEquals(const char *block, char value) {
+        unsigned char diff = 0;
+        for (std::size_t i = 0; i < blockSize; ++i) {
+            diff |= static_cast<unsigned char>(block[i] ^ value);
+        }
+        return diff == 0;
+    }
+
+#if LIST_AVX2_DISPATCH
+    // Collapses whole blocks of in. Comparing a block with itself shifted by
+    // one char marks every run start at once; each start emits the run
+    // before it, whose char and length are read off the same mask.
+    __attribute__((target("avx2")))
+    static char *collapseBlocksAvx2(const char *in, std::size_t blocks, char *out, char &prev, bool &run) {
+        for (; blocks != 0; --blocks, in += blockSize) {
+            const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+            // chars moved up one byte, across the lane boundary; byte 0 is zero.
+            const __m256i shifted = _mm256_alignr_epi8(chars, _mm256_permute2x128_si256(chars, chars, 0x08), 15);
+            uint32_t starts = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, shifted)));
+            // withPrev[i] precedes in[i]; the copy also keeps in-place output from clobbering it.
+            char withPrev[blockSize + 1];
+            withPrev[0] = prev;
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(withPrev + 1), chars);
+            starts = (starts & ~1u) | static_cast<uint32_t>(withPrev[1] != prev);
+            if (starts == 0) {
+                run = true;
+                continue;
+            }
+            // Bit i is set when the run ending just before in[i] has one char.
+            const uint64_t single = (static_cast<uint64_t>(starts) << 1) | (run ? 0 : 1);
+            if (__builtin_popcount(starts) <= denseStarts) {
+                for (uint32_t pending = starts; pending != 0; pending &= pending - 1) {
+                    const unsigned i = static_cast<unsigned>(__builtin_ctz(pending));
+                    *out++ = static_cast<char>(withPrev[i] - (((single >> i) & 1) != 0 ? 0 : shift));
+                }
+            } else {
+                // Short runs: store at every position, advance on starts only.
+                for (unsigned i = 0; i < blockSize; ++i) {
+                    *out = static_cast<char>(withPrev[i] - (((single >> i) & 1) != 0 ? 0 : shift));
+                    out += (starts >> i) & 1;
+                }
+            }
+            prev = withPrev[blockSize];
+            run = (starts >> (blockSize - 1)) == 0;
+        }
+        return out;
+    }
+#endif
+
+public:
+    template<typename InputIt, typename OutputIt>
+    OutputIt feed(InputIt first, InputIt last, OutputIt out) {
+        if constexpr (std::is_pointer_v<InputIt> && std::is_pointer_v<OutputIt>) {
+            if (first == last) {
+                return out;
+            }
+            if (!havePending) {
+                pending = *first++;
+                pendingIsRun = false;
+                havePending = true;
+            }
+            char prev = pending;
+            bool run = pendingIsRun;
+            // Branch-free compaction: the previous char is always stored and
+            // the output only advances when the current char ends its run.
+            auto step = [&](char c) {
+                *out = static_cast<char>(prev - (run ? shift : 0));
+                out += (c != prev);
+                run = (c == prev);
+                prev = c;
+            };
+#if LIST_AVX2_DISPATCH
+            if constexpr (std::is_same_v<OutputIt, char *>) {
+                if (cpuHasAvx2()) {
+                    const std::size_t blocks = static_cast<std::size_t>(last - first) / blockSize;
+                    out = collapseBlocksAvx2(first, blocks, out, prev, run);
+                    first += blocks * blockSize;
+                }
+            }
+#endif
+            while (static_cast<std::size_t>(last - first) >= blockSize) {
+                if (blockEquals(first, prev)) {
+                    run = true;
+                } else {
+                    for (std::size_t i = 0; i < blockSize; ++i) {
+                        step(first[i]);
+                    }
+                }
+                first += blockSize;
+            }
+            for (; first != last; ++first) {
+                step(*first);
+            }
+            pending = prev;
+            pendingIsRun = run;
+            return out;
+        } else {
+            for (; first != last; ++first) {
+                char c = *first;
+                if (havePending && c == pending) {
+                    pendingIsRun = true;
+                    continue;
+                }
+                if (havePending) {
+                    *out = static_cast<char>(pending - (pendingIsRun ? shift : 0));
+                    ++out;
+                }
+                pending = c;
+                pendingIsRun = false;
+                havePending = true;
+            }
+            return out;
+        }
+    }
+
+    template<typename OutputIt>
+    OutputIt finish(OutputIt out) {
+        if (havePending) {
+            *out = static_cast<char>(pending - (pendingIsRun ? shift : 0));
+            ++out;
+            havePending = false;
+        }
+        return out;
+    }
+};
+
+// Transforms the n chars at in into out (which may equal in) and returns the
+// number of chars written.
+std::size_t collapseRuns(const char *in, std::size_t n, char *out) {
+    RunLengthTransformer engine;
+    char *end = engine.feed(in, in + n, out);
+    return engine.finish(end) - out;
+}
+
+// Streams in to out in chunks of chunkBytes, transforming each chunk in place.
+void collapseRuns(std::istream &in, std::ostream &out, std::size_t chunkBytes = 1 << 16) {
+    RunLengthTransformer engine;
+    std::vector<char> buffer(std::max<std::size_t>(chunkBytes, 1));
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = in.gcount();
+        if (count <= 0) {
+            break;
+        }
+        char *end = engine.feed(buffer.data(), buffer.data() + count, buffer.data());
+        out.write(buffer.data(), end - buffer.data());
+    }
+    char *end = engine.finish(buffer.data());
+    out.write(buffer.data(), end - buffer.data());
+}
+
+// Rewrites the list in place and erases the leftover tail; no nodes are allocated.
+void minorsToCapitals(List<char>& list)
+{
+    RunLengthTransformer engine;
+    auto end = engine.feed(list.begin(), list.end(), list.begin());
+    end = engine.finish(end);
+    list.erase(end, list.end());
+}
+
+//task 03
+template<typename InputIt, typename T>
+bool binarySearch(InputIt first, InputIt last, const T& value) {
+    if constexpr (std::is_same_v<typename std::iterator_traits<InputIt>::iterator_category, std::random_access_iterator_tag>) {
+        return std::binary_search(first, last, value);
+    } else {
+        for (; first != last; ++first) {
+            if (*first == value) {
+                return true;
+            } else if (*first > value) {
+                return false;
+            }
+        }
+        return false;
+    }
+}
+
+// Sorted-list search through List::lower_bound, which uses the skip-list
+// index when one has been built.
+template<typename T>
+bool binarySearch(const List<T>& list, const T& value) {
+    auto it = list.lower_bound(value);
+    return it != list.end() && !(value < *it);
+}
+
+#ifndef LIST_NO_MAIN
+int main()
+{
+    //task 01
+    List<int> list { 6, -2, 5, 4, 0, 3 };
+    partitionLinkedList(list, 4);
+
+    for (const auto& value : list) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+
+    //task 02
+    List<char> chList { 'a', 'a', 'b', 'c', 'c', 'c' };
+    minorsToCapitals(chList);
+
+    for ( auto it = chList.begin(); it != chList.end(); ++it)
+    {
+        std::cout << *it << " ";
+    }
+
+    std::cout << std::endl;
+
+    //task 03
     std::vector<int> vec = {1, 2, 4, 4, 5};
     List<int> lst = {1, 2, 3, 4, 5};
 
@@ -441,4 +1956,5 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,546 @@
+// Benchmarks for the lists in doubleLinkedList.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread doubleLinkedList_bench.cpp -o doubleLinkedList_bench
+//   ./doubleLinkedList_bench [section] [size]
+//
+// Without arguments every section runs at its default size; a section name
+// runs only that section, optionally at another size.
+
+#define LIST_NO_MAIN
+#include "doubleLinkedList.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+
+template<typename Body>
+double secondsFor(Body body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps results observable so the timed work is not optimized away.
+static size_t sink = 0;
+
+// Every allocation made through the global operator new, which the
+// container allocators and the List node pool all end up in. The operators
+// stay out of line: inlined, GCC sees malloc behind new and free behind
+// delete and warns about mismatched allocation functions.
+static size_t allocations = 0;
+
+__attribute__((noinline)) void *operator new(size_t bytes) {
+    ++allocations;
+    if (void *memory = std::malloc(bytes != 0 ? bytes : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+// List as it was before the node pool, reduced to what the benchmarks need:
+// every push allocates a node with new, every pop deletes it, and clear()
+// pops one node at a time.
+template<typename T>
+class LegacyList {
+    struct Node {
+        T data;
+        Node *next;
+        Node *prev;
+    };
+
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    size_t size_ = 0;
+
+public:
+    LegacyList() = default;
+    LegacyList(const LegacyList &) = delete;
+    LegacyList &operator=(const LegacyList &) = delete;
+    ~LegacyList() { clear(); }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    T &front() { return head->data; }
+
+    void push_back(const T &value) {
+        Node *node = new Node{value, nullptr, tail};
+        if (tail != nullptr) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        ++size_;
+    }
+
+    void pop_front() {
+        if (head == nullptr) {
+            return;
+        }
+        Node *node = head;
+        head = head->next;
+        if (head != nullptr) {
+            head->prev = nullptr;
+        } else {
+            tail = nullptr;
+        }
+        delete node;
+        --size_;
+    }
+
+    void clear() {
+        while (!empty()) {
+            pop_front();
+        }
+    }
+};
+
+// Runs a queue of `depth` elements through `operations` push_back/pop_front
+// pairs, then fills it to `operations` elements and clears it.
+template<typename Queue>
+void churn(const char *name, size_t operations, size_t depth) {
+    Queue queue;
+    for (size_t i = 0; i < depth; ++i) {
+        queue.push_back(static_cast<int>(i));
+    }
+    const double steady = secondsFor([&] {
+        for (size_t i = 0; i < operations; ++i) {
+            queue.push_back(static_cast<int>(i));
+            sink += static_cast<size_t>(queue.front());
+            queue.pop_front();
+        }
+    });
+    for (size_t i = queue.size(); i < operations; ++i) {
+        queue.push_back(static_cast<int>(i));
+    }
+    const double cleared = secondsFor([&] { queue.clear(); });
+    std::printf("churn     %-12s %6.1f ns per push+pop, clear of %zu in %.3f ms\n", name,
+                steady * 1e9 / static_cast<double>(operations), operations, cleared * 1e3);
+}
+
+// Queue churn of the pooled List against the new/delete version and
+// std::list.
+void benchChurn(size_t operations) {
+    const size_t depth = 1000;
+    churn<LegacyList<int>>("legacy List", operations, depth);
+    churn<List<int>>("List", operations, depth);
+    churn<std::list<int>>("std::list", operations, depth);
+}
+
+// Sequential scan, insertion at a fixed middle position and splicing of
+// a separately built 1000-element list into the middle, for a list of n ints.
+template<typename Sequence>
+void layout(const char *name, size_t n) {
+    Sequence values;
+    for (size_t i = 0; i < n; ++i) {
+        values.push_back(static_cast<int>(i));
+    }
+
+    const size_t scans = 10;
+    const double scan = secondsFor([&] {
+        for (size_t round = 0; round < scans; ++round) {
+            long long sum = 0;
+            for (int value : values) {
+                sum += value;
+            }
+            sink += static_cast<size_t>(sum);
+        }
+    });
+
+    const size_t inserts = 1000000;
+    auto middle = values.begin();
+    std::advance(middle, n / 2);
+    const double insert = secondsFor([&] {
+        for (size_t i = 0; i < inserts; ++i) {
+            middle = values.insert(middle, static_cast<int>(i));
+        }
+    });
+
+    const size_t splices = 1000;
+    double splice = 0;
+    for (size_t round = 0; round < splices; ++round) {
+        Sequence other;
+        for (int i = 0; i < 1000; ++i) {
+            other.push_back(i);
+        }
+        auto pos = values.begin();
+        std::advance(pos, round);
+        splice += secondsFor([&] { values.splice(pos, other); });
+    }
+    sink += values.size();
+
+    std::printf("layout    %-20s scan %5.2f ns per element, middle insert %5.1f ns, splice %6.1f ns\n", name,
+                scan * 1e9 / static_cast<double>(scans * n), insert * 1e9 / static_cast<double>(inserts),
+                splice * 1e9 / static_cast<double>(splices));
+}
+
+// UnrolledList against the pointer-per-element List.
+void benchLayout(size_t n) {
+    std::printf("layout    %zu ints\n", n);
+    layout<List<int>>("List", n);
+    layout<UnrolledList<int, 16>>("UnrolledList<16>", n);
+    layout<UnrolledList<int, 64>>("UnrolledList<64>", n);
+}
+
+// partitionLinkedList as it was before the relinking rewrite: every element
+// is copied into one of two new lists and erased from the original, and the
+// result is copy-assigned back. Run on std::list, which like the old List
+// allocates one node per element.
+template<typename T>
+void legacyPartition(std::list<T> &list, const T &x) {
+    std::list<T> less;
+    std::list<T> greaterOrEqual;
+    std::list<T> single{ x };
+
+    for (auto it = list.begin(); it != list.end();) {
+        auto next = it;
+        ++next;
+        if (*it != x) {
+            if (*it < x) {
+                less.push_back(*it);
+            } else {
+                greaterOrEqual.push_back(*it);
+            }
+        }
+        list.erase(it);
+        it = next;
+    }
+
+    less.splice(less.end(), single);
+    less.splice(less.end(), greaterOrEqual);
+    list = less;
+}
+
+// Partitions n ints in [0, 1000) around 500 with the copying algorithm and
+// with the in-place partitionLinkedList, reporting time and allocations.
+void benchPartition(size_t n) {
+    std::minstd_rand rng(1);
+    std::vector<int> values(n);
+    for (int &value : values) {
+        value = static_cast<int>(rng() % 1000);
+    }
+
+    std::list<int> copied(values.begin(), values.end());
+    size_t before = allocations;
+    const double legacy = secondsFor([&] { legacyPartition(copied, 500); });
+    const size_t legacyAllocations = allocations - before;
+
+    List<int> relinked;
+    for (int value : values) {
+        relinked.push_back(value);
+    }
+    before = allocations;
+    const double inPlace = secondsFor([&] { partitionLinkedList(relinked, 500); });
+    const size_t inPlaceAllocations = allocations - before;
+
+    sink += copied.size() + relinked.size();
+    std::printf("partition %zu ints: copying %.3f s, %.2f allocations per element; "
+                "in place %.3f s, %zu allocations\n",
+                n, legacy, static_cast<double>(legacyAllocations) / static_cast<double>(n), inPlace,
+                inPlaceAllocations);
+}
+
+// n lowercase chars in runs of random length up to maxRun.
+std::vector<char> runText(size_t n, unsigned maxRun) {
+    std::minstd_rand rng(2);
+    std::vector<char> text(n);
+    size_t i = 0;
+    while (i < n) {
+        const char c = static_cast<char>('a' + rng() % 26);
+        for (size_t run = 1 + rng() % maxRun; run > 0 && i < n; --run) {
+            text[i++] = c;
+        }
+    }
+    return text;
+}
+
+// Throughput of the run-length engine on a contiguous buffer, through an
+// istream in 64 KiB chunks and over a List<char>, for short and long runs.
+void benchRuns(size_t n) {
+    const size_t listChars = std::min<size_t>(n, 10000000);
+    for (unsigned maxRun : {2u, 64u}) {
+        const std::vector<char> text = runText(n, maxRun);
+        std::vector<char> out(n);
+
+        size_t written = 0;
+        const double buffer = secondsFor([&] { written = collapseRuns(text.data(), n, out.data()); });
+
+        std::istringstream in(std::string(text.begin(), text.end()));
+        std::ostringstream collapsed;
+        const double stream = secondsFor([&] { collapseRuns(in, collapsed); });
+
+        List<char> chars;
+        for (size_t i = 0; i < listChars; ++i) {
+            chars.push_back(text[i]);
+        }
+        const double list = secondsFor([&] { minorsToCapitals(chars); });
+
+        sink += written + collapsed.tellp() + chars.size();
+        auto gbs = [](size_t bytes, double seconds) { return static_cast<double>(bytes) / seconds / 1e9; };
+        std::printf("runs      runs up to %-2u chars, %zu MB: buffer %.2f GB/s, istream %.2f GB/s, "
+                    "List<char> %.3f GB/s\n",
+                    maxRun, n / 1000000, gbs(n, buffer), gbs(n, stream), gbs(listChars, list));
+    }
+}
+
+// Search in sorted lists of 1M keys up to `largest` in steps of ten:
+// binarySearch over List iterators (a linear scan) against binarySearch on
+// the list with a skip-list index, plus the cost of building the index.
+void benchSkipIndex(size_t largest) {
+    for (size_t n = 1000000; n <= largest; n *= 10) {
+        List<int> sorted;
+        for (size_t i = 0; i < n; ++i) {
+            sorted.push_back(static_cast<int>(2 * i));
+        }
+        auto key = [n](size_t q) { return static_cast<int>(2 * ((q * 2654435761u) % n)); };
+
+        const size_t scans = 20;
+        const double linear = secondsFor([&] {
+            for (size_t q = 0; q < scans; ++q) {
+                sink += binarySearch(sorted.begin(), sorted.end(), key(q));
+            }
+        });
+
+        const double build = secondsFor([&] { sorted.build_index(); });
+        const size_t lookups = 1000000;
+        const double indexed = secondsFor([&] {
+            for (size_t q = 0; q < lookups; ++q) {
+                sink += binarySearch(sorted, key(q));
+            }
+        });
+
+        std::printf("skip      %-10zu keys: linear %10.0f ns, indexed %6.0f ns per search, index built in %.2f s\n",
+                    n, linear * 1e9 / static_cast<double>(scans), indexed * 1e9 / static_cast<double>(lookups),
+                    build);
+    }
+}
+
+// Cached object for the LRU benchmark: a key, a payload the copying lists
+// have to carry along, and the hook IntrusiveList threads it through.
+struct CacheEntry {
+    uint32_t key = 0;
+    char payload[52] = {};
+    ListHook<CacheEntry> lru;
+};
+
+// Keys for `count` cache accesses over `keys` keys, eight in ten of them
+// from the hottest tenth of the key space.
+std::vector<uint32_t> lruKeys(size_t count, uint32_t keys) {
+    std::vector<uint32_t> result(count);
+    uint64_t state = 88172645463325252ull;
+    for (uint32_t &key : result) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const bool hot = state % 10 < 8;
+        key = static_cast<uint32_t>((state >> 8) % (hot ? keys / 10 : keys));
+    }
+    return result;
+}
+
+// LRU cache over a list that holds CacheEntry by value (List or std::list):
+// a hit splices the node to the front unless it is there already, a miss
+// drops the back and pushes a copy of the new entry.
+template<typename Container>
+size_t copyingLru(const std::vector<uint32_t> &accesses, uint32_t keys, size_t capacity) {
+    Container order;
+    std::vector<typename Container::iterator> where(keys, order.end());
+    size_t hits = 0;
+    for (uint32_t key : accesses) {
+        if (where[key] != order.end()) {
+            if (where[key] != order.begin()) {
+                order.splice(order.begin(), order, where[key], std::next(where[key]));
+            }
+            ++hits;
+            continue;
+        }
+        if (order.size() == capacity) {
+            where[order.back().key] = order.end();
+            order.pop_back();
+        }
+        CacheEntry entry;
+        entry.key = key;
+        order.push_front(entry);
+        where[key] = order.begin();
+    }
+    return hits;
+}
+
+// The same cache with its entries preallocated in a vector and threaded
+// onto an IntrusiveList: a miss recycles the back entry in place.
+size_t intrusiveLru(const std::vector<uint32_t> &accesses, uint32_t keys, size_t capacity) {
+    std::vector<CacheEntry> entries(capacity);
+    IntrusiveList<CacheEntry, &CacheEntry::lru> order;
+    std::vector<CacheEntry *> where(keys, nullptr);
+    size_t used = 0;
+    size_t hits = 0;
+    for (uint32_t key : accesses) {
+        if (CacheEntry *entry = where[key]) {
+            auto it = order.iterator_to(*entry);
+            if (it != order.begin()) {
+                order.splice(order.begin(), order, it, std::next(it));
+            }
+            ++hits;
+            continue;
+        }
+        CacheEntry *entry;
+        if (used < capacity) {
+            entry = &entries[used++];
+        } else {
+            entry = &order.back();
+            where[entry->key] = nullptr;
+            order.pop_back();
+        }
+        entry->key = key;
+        order.push_front(*entry);
+        where[key] = entry;
+    }
+    return hits;
+}
+
+// LRU move-to-front with `accesses` accesses over 1M keys and a 64K-entry
+// cache: IntrusiveList against List and std::list holding the entries.
+void benchLru(size_t accesses) {
+    const uint32_t keys = 1000000;
+    const size_t capacity = 65536;
+    const std::vector<uint32_t> trace = lruKeys(accesses, keys);
+
+    auto run = [&](const char *name, auto cache) {
+        size_t hits = 0;
+        const size_t before = allocations;
+        const double seconds = secondsFor([&] { hits = cache(trace, keys, capacity); });
+        sink += hits;
+        std::printf("lru       %-14s %.1f ns per access, %.2f allocations per access, %.1f%% hits\n", name,
+                    seconds * 1e9 / static_cast<double>(accesses),
+                    static_cast<double>(allocations - before) / static_cast<double>(accesses),
+                    100.0 * static_cast<double>(hits) / static_cast<double>(accesses));
+    };
+    run("IntrusiveList", intrusiveLru);
+    run("List", copyingLru<List<CacheEntry>>);
+    run("std::list", copyingLru<std::list<CacheEntry>>);
+}
+
+// List behind one mutex, the baseline the lock-free deque replaces.
+template<typename T>
+class LockedDeque {
+    std::mutex lock;
+    List<T> items;
+
+public:
+    void push_back(T value) {
+        std::lock_guard<std::mutex> held(lock);
+        items.push_back(std::move(value));
+    }
+    void push_front(T value) {
+        std::lock_guard<std::mutex> held(lock);
+        items.push_front(std::move(value));
+    }
+    std::optional<T> try_pop_front() {
+        std::lock_guard<std::mutex> held(lock);
+        if (items.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(items.front()));
+        items.pop_front();
+        return value;
+    }
+    std::optional<T> try_pop_back() {
+        std::lock_guard<std::mutex> held(lock);
+        if (items.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(items.back()));
+        items.pop_back();
+        return value;
+    }
+};
+
+// `threads` threads each make `perThread` operations: a push at one end
+// followed by a pop at the other, alternating ends, so the deque stays short
+// and every operation contends for the same anchor or mutex.
+template<typename Deque>
+double dequeSeconds(size_t threads, size_t perThread) {
+    Deque deque;
+    for (size_t i = 0; i < 64; ++i) {
+        deque.push_back(i);
+    }
+    return secondsFor([&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&deque, t, perThread] {
+                size_t seen = 0;
+                for (size_t i = 0; i < perThread; ++i) {
+                    if ((i + t) % 2 == 0) {
+                        deque.push_back(i);
+                        seen += deque.try_pop_front().value_or(0);
+                    } else {
+                        deque.push_front(i);
+                        seen += deque.try_pop_back().value_or(0);
+                    }
+                }
+                static std::mutex sinkLock;
+                std::lock_guard<std::mutex> held(sinkLock);
+                sink += seen + 1;
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+// Push and pop throughput of ConcurrentDeque against LockedDeque for 1 to 64
+// threads sharing `operations` push-pop pairs.
+void benchDeque(size_t operations) {
+    for (size_t threads = 1; threads <= 64; threads *= 4) {
+        const size_t perThread = operations / threads;
+        const double lockFree = dequeSeconds<ConcurrentDeque<size_t>>(threads, perThread);
+        const double locked = dequeSeconds<LockedDeque<size_t>>(threads, perThread);
+        const double scale = 1e9 / static_cast<double>(perThread * threads);
+        std::printf("deque     %2zu threads: lock-free %.1f ns, mutex + List %.1f ns per push-pop pair\n", threads,
+                    lockFree * scale, locked * scale);
+    }
+}
+
+int main(int argc, char **argv) {
+    const std::string only = argc > 1 ? argv[1] : "";
+    const size_t size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    auto wants = [&](const char *name) { return only.empty() || only == name; };
+
+    if (wants("churn")) {
+        benchChurn(size != 0 ? size : 10000000);
+    }
+    if (wants("layout")) {
+        benchLayout(size != 0 ? size : 10000000);
+    }
+    if (wants("partition")) {
+        benchPartition(size != 0 ? size : 10000000);
+    }
+    if (wants("runs")) {
+        benchRuns(size != 0 ? size : 256000000);
+    }
+    if (wants("skip")) {
+        benchSkipIndex(size != 0 ? size : 10000000);
+    }
+    if (wants("lru")) {
+        benchLru(size != 0 ? size : 20000000);
+    }
+    if (wants("deque")) {
+        benchDeque(size != 0 ? size : 4000000);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
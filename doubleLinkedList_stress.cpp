@@ -0,0 +1,138 @@
+// Stress test for ConcurrentDeque in doubleLinkedList.cpp.
+//
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -pthread doubleLinkedList_stress.cpp -o stress && ./stress
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread doubleLinkedList_stress.cpp -o stress && ./stress
+//   ./stress [values per producer]
+//
+// Four producers push tagged values, alternating front and back, while four
+// consumers alternate try_pop_front and try_pop_back; every value must come
+// out exactly once. A single-threaded run against std::deque checks the
+// order at both ends first. Exits non-zero on the first failure.
+
+#define LIST_NO_MAIN
+#include "doubleLinkedList.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+
+// Random single-threaded operations on both containers, which must agree
+// on every popped value.
+bool matchesStdDeque(size_t operations) {
+    ConcurrentDeque<std::unique_ptr<size_t>> deque;
+    std::deque<size_t> expected;
+    std::mt19937 random(7);
+    for (size_t i = 0; i < operations; ++i) {
+        switch (random() % 4) {
+            case 0:
+                deque.push_back(std::make_unique<size_t>(i));
+                expected.push_back(i);
+                break;
+            case 1:
+                deque.push_front(std::make_unique<size_t>(i));
+                expected.push_front(i);
+                break;
+            case 2: {
+                auto popped = deque.try_pop_back();
+                if (popped.has_value() != !expected.empty() || (popped && **popped != expected.back())) {
+                    std::printf("try_pop_back disagrees with std::deque at operation %zu\n", i);
+                    return false;
+                }
+                if (popped) {
+                    expected.pop_back();
+                }
+                break;
+            }
+            default: {
+                auto popped = deque.try_pop_front();
+                if (popped.has_value() != !expected.empty() || (popped && **popped != expected.front())) {
+                    std::printf("try_pop_front disagrees with std::deque at operation %zu\n", i);
+                    return false;
+                }
+                if (popped) {
+                    expected.pop_front();
+                }
+                break;
+            }
+        }
+        if (deque.empty() != expected.empty()) {
+            std::printf("empty() disagrees with std::deque at operation %zu\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every value is producer * perProducer + sequence; consumers mark what
+// they see and the marks must each be hit exactly once.
+bool survivesContention(size_t producers, size_t consumers, size_t perProducer) {
+    ConcurrentDeque<std::unique_ptr<size_t>> deque;
+    const size_t total = producers * perProducer;
+    std::vector<std::atomic<uint8_t>> seen(total);
+    std::atomic<size_t> consumed{0};
+    std::atomic<bool> duplicate{false};
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (size_t i = 0; i < perProducer; ++i) {
+                auto value = std::make_unique<size_t>(p * perProducer + i);
+                if (i % 2 == 0) {
+                    deque.push_back(std::move(value));
+                } else {
+                    deque.push_front(std::move(value));
+                }
+            }
+        });
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            bool fromFront = c % 2 == 0;
+            while (consumed.load() < total) {
+                auto popped = fromFront ? deque.try_pop_front() : deque.try_pop_back();
+                fromFront = !fromFront;
+                if (!popped) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (seen[**popped].fetch_add(1) != 0) {
+                    duplicate = true;
+                }
+                consumed.fetch_add(1);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    if (duplicate) {
+        std::printf("%zux%zu: a value was popped twice\n", producers, consumers);
+        return false;
+    }
+    for (size_t i = 0; i < total; ++i) {
+        if (seen[i].load() != 1) {
+            std::printf("%zux%zu: value %zu was popped %u times\n", producers, consumers, i, seen[i].load());
+            return false;
+        }
+    }
+    if (!deque.empty()) {
+        std::printf("%zux%zu: deque not empty after every value was popped\n", producers, consumers);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const size_t perProducer = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+    if (!matchesStdDeque(200000)) {
+        return 1;
+    }
+    if (!survivesContention(4, 4, perProducer)) {
+        return 1;
+    }
+    std::printf("ok: std::deque agreement, 4x4 contention with %zu values per producer\n", perProducer);
+    return 0;
+}
@@ -1,37 +1,166 @@
+#include <algorithm>
+#include <cctype>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <cmath>
 
-template <typename T>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TOPK_AVX2_DISPATCH 1
+#else
+#define TOPK_AVX2_DISPATCH 0
+#endif
+
+#if defined(__GNUC__)
+#define TOPK_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define TOPK_ALWAYS_INLINE inline
+#endif
+
+// Projection that orders elements by themselves; no key is cached for it.
+struct Identity
+{
+    template <typename U>
+    const U &operator()(const U &value) const
+    {
+        return value;
+    }
+};
+
+// Heap whose top is the element with the greatest projected key under
+// Compare (std::less<> gives a max-heap, std::greater<> a min-heap). Keys are
+// projected once on insertion and stored next to their element. Arity sets
+// the number of children per node; 4 or 8 make sift-down shallower and keep
+// the children it scans in one cache line.
+template <typename T, typename Compare = std::less<>, typename Projection = Identity, size_t Arity = 2>
 class PriorityQueue
 {
+    static_assert(Arity >= 2, "PriorityQueue needs at least two children per node");
+
 private:
-    std::vector<T> heap;
+    using Key = std::decay_t<std::invoke_result_t<Projection &, const T &>>;
+    static constexpr bool cachesKey = !std::is_same_v<Projection, Identity>;
 
-public:
-    template <typename InputIt>
-    PriorityQueue(InputIt first, InputIt last)
+    struct KeyedEntry
+    {
+        Key key;
+        T value;
+    };
+    using Entry = std::conditional_t<cachesKey, KeyedEntry, T>;
+
+    std::vector<Entry> heap;
+    Compare compare;
+    Projection projection;
+
+    static const auto &keyOf(const Entry &entry)
     {
-        while (first != last)
+        if constexpr (cachesKey)
         {
-            heap.push(*first);
-            ++first;
+            return entry.key;
         }
-        for (int index = heap.size() / 2 - 1; index >= 0; --index)
+        else
         {
-            int child = 2 * index + 1;
-            if (child + 1 < heap.size() && heap[child + 1] > heap[child])
-            {
-                ++child;
-            }
-            if (heap[child] > heap[index])
+            return entry;
+        }
+    }
+
+    static const T &valueOf(const Entry &entry)
+    {
+        if constexpr (cachesKey)
+        {
+            return entry.value;
+        }
+        else
+        {
+            return entry;
+        }
+    }
+
+    Entry makeEntry(const T &value)
+    {
+        if constexpr (cachesKey)
+        {
+            return Entry{projection(value), value};
+        }
+        else
+        {
+            return value;
+        }
+    }
+
+    // True when lhs belongs below rhs.
+    bool lower(const Entry &lhs, const Entry &rhs) const
+    {
+        return compare(keyOf(lhs), keyOf(rhs));
+    }
+
+    void siftUp(size_t index)
+    {
+        Entry entry = std::move(heap[index]);
+        while (index > 0 && lower(heap[(index - 1) / Arity], entry))
+        {
+            heap[index] = std::move(heap[(index - 1) / Arity]);
+            index = (index - 1) / Arity;
+        }
+        heap[index] = std::move(entry);
+    }
+
+    // Moves the hole at index down to a leaf along the best children, then
+    // lets the displaced entry rise from there. The elements popped from the
+    // bottom usually belong near the leaves, so this skips most comparisons
+    // against the entry itself.
+    void siftDown(size_t index)
+    {
+        const size_t start = index;
+        const size_t count = heap.size();
+        Entry entry = std::move(heap[index]);
+        while (Arity * index + 1 < count)
+        {
+            const size_t firstChild = Arity * index + 1;
+            const size_t lastChild = std::min(firstChild + Arity, count);
+            size_t bestChild = firstChild;
+            for (size_t child = firstChild + 1; child < lastChild; ++child)
             {
-                std::swap(heap[index], heap[child]);
+                if (lower(heap[bestChild], heap[child]))
+                {
+                    bestChild = child;
+                }
             }
+            heap[index] = std::move(heap[bestChild]);
+            index = bestChild;
+        }
+        while (index > start && lower(heap[(index - 1) / Arity], entry))
+        {
+            heap[index] = std::move(heap[(index - 1) / Arity]);
+            index = (index - 1) / Arity;
+        }
+        heap[index] = std::move(entry);
+    }
+
+    // Floyd's bottom-up construction, O(N).
+    void heapify()
+    {
+        for (size_t index = (heap.size() + Arity - 2) / Arity; index > 0; --index)
+        {
+            siftDown(index - 1);
         }
     }
 
-    PriorityQueue() = default;
+public:
+    template <typename InputIt>
+    PriorityQueue(InputIt first, InputIt last, Compare compare_ = Compare(), Projection projection_ = Projection())
+        : compare(std::move(compare_)), projection(std::move(projection_))
+    { // O(N)
+        push_range(first, last);
+    }
+
+    explicit PriorityQueue(Compare compare_ = Compare(), Projection projection_ = Projection())
+        : compare(std::move(compare_)), projection(std::move(projection_)) {}
 
     bool empty() const
     { // O(1)
@@ -49,70 +178,294 @@ public:
 
     void push(const T &value)
     { // O(log(N))
-        heap.push_back(value);
-        int index = heap.size() - 1;
-        while (index > 0 && heap[(index - 1) / 2] < value)
+        heap.push_back(makeEntry(value));
+        siftUp(heap.size() - 1);
+    }
+
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last)
+    { // O(K log(N)) or O(N + K), whichever is smaller
+        const size_t oldSize = heap.size();
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+        {
+            heap.reserve(oldSize + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first)
         {
-            std::swap(heap[index], heap[(index - 1) / 2]);
-            index = (index - 1) / 2;
+            heap.push_back(makeEntry(*first));
+        }
+        const size_t added = heap.size() - oldSize;
+
+        size_t depth = 0;
+        for (size_t count = heap.size(); count > 1; count /= Arity)
+        {
+            ++depth;
+        }
+        if (added * depth >= heap.size())
+        {
+            heapify();
+            return;
+        }
+        for (size_t index = oldSize; index < heap.size(); ++index)
+        {
+            siftUp(index);
         }
     }
 
     void pop()
-    { 
+    { // O(log(N))
         if (empty())
         {
             return;
         }
 
-        std::swap(heap[0], heap[size() - 1]);
+        heap[0] = std::move(heap.back());
         heap.pop_back();
-        int index = 0;
-
-        while (2 * index + 1 < size())
+        if (!empty())
         {
-            int largestChild = 2 * index + 1;
-
-            if (largestChild + 1 < size() && heap[largestChild + 1] > heap[largestChild])
-            {
-                largestChild = largestChild + 1;
-            }
+            siftDown(0);
+        }
+    }
 
-            if (heap[largestChild] > heap[index])
+    // Moves up to count top elements to out, in pop order.
+    template <typename OutputIt>
+    OutputIt pop_n(size_t count, OutputIt out)
+    { // O(K log(N))
+        while (count > 0 && !empty())
+        {
+            if constexpr (cachesKey)
             {
-                std::swap(heap[index], heap[largestChild]);
-                index = largestChild;
+                *out = std::move(heap[0].value);
             }
             else
             {
-                break;
+                *out = std::move(heap[0]);
             }
+            ++out;
+            pop();
+            --count;
+        }
+        return out;
+    }
+
+    // Same as pop() followed by push(value), with a single sift.
+    void replace_top(const T &value)
+    { // O(log(N))
+        if (empty())
+        {
+            push(value);
+            return;
         }
+        heap[0] = makeEntry(value);
+        siftDown(0);
     }
 
     const T &top() const
-    { 
+    { // O(1)
+        if (empty())
+        {
+            throw std::out_of_range("PriorityQueue is empty");
+        }
+        return valueOf(heap[0]);
+    }
+
+    // Projected key of top(), read from the cache instead of recomputed.
+    const Key &top_key() const
+    { // O(1)
         if (empty())
         {
             throw std::out_of_range("PriorityQueue is empty");
         }
-        return heap[0];
+        return keyOf(heap[0]);
     }
 };
 
+// Keeps the k elements whose projected keys come first under Compare (the k
+// smallest with std::less<>). The worst kept element sits on top of a 4-ary
+// max-heap, and its key is the threshold a candidate has to beat.
+template <typename T, typename Compare = std::less<>, typename Projection = Identity>
+class TopK
+{
+private:
+    using Key = std::decay_t<std::invoke_result_t<Projection &, const T &>>;
+    static constexpr size_t blockSize = 64;
+
+    size_t limit;
+    Compare compare;
+    Projection projection;
+    PriorityQueue<T, Compare, Projection, 4> heap;
+
+    // How many of the blockSize candidates from block beat threshold. Every
+    // key is compared and counted, not or-ed into a bool, so the loop is a
+    // plain sum reduction without an early exit, the form compilers vectorize.
+    // Forced inline so each caller compiles it for its own target.
+    template <typename RandomIt>
+    TOPK_ALWAYS_INLINE size_t countBelow(RandomIt block, const Key &threshold)
+    {
+        size_t below = 0;
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            below += compare(projection(block[i]), threshold) ? 1 : 0;
+        }
+        return below;
+    }
+
+#if TOPK_AVX2_DISPATCH
+    // countBelow compiled for AVX2, which has the 64-bit multiplies and
+    // compares that keys such as the squared distance need; baseline x86-64
+    // leaves the loop scalar.
+    template <typename RandomIt>
+    __attribute__((target("avx2"))) size_t countBelowAvx2(RandomIt block, const Key &threshold)
+    {
+        return countBelow(block, threshold);
+    }
+
+    static bool cpuHasAvx2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+
+    template <typename RandomIt>
+    size_t countBelowTop(RandomIt block)
+    {
+        const Key &threshold = heap.top_key();
+#if TOPK_AVX2_DISPATCH
+        if (cpuHasAvx2())
+        {
+            return countBelowAvx2(block, threshold);
+        }
+#endif
+        return countBelow(block, threshold);
+    }
+
+public:
+    explicit TopK(size_t k, Compare compare_ = Compare(), Projection projection_ = Projection())
+        : limit(k), compare(compare_), projection(projection_), heap(compare_, projection_) {}
+
+    size_t size() const
+    { // O(1)
+        return heap.size();
+    }
+
+    void push(const T &value)
+    { // O(log(K))
+        if (heap.size() < limit)
+        {
+            heap.push(value);
+        }
+        else if (limit > 0 && compare(projection(value), heap.top_key()))
+        {
+            heap.replace_top(value);
+        }
+    }
+
+    // Once the heap is full, candidates are screened against the top's key
+    // where they lie, without copying them. Over random-access input the
+    // screen counts a block at a time in a loop that vectorizes for
+    // arithmetic keys; blocks without a better key never touch the heap.
+    template <typename InputIt>
+    void push_batch(InputIt first, InputIt last)
+    { // O(N) plus O(log(K)) per accepted element
+        while (first != last && heap.size() < limit)
+        {
+            heap.push(*first);
+            ++first;
+        }
+        if (first == last || limit == 0)
+        {
+            return;
+        }
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+        {
+            while (last - first >= static_cast<std::ptrdiff_t>(blockSize))
+            {
+                if (countBelowTop(first) > 0)
+                {
+                    for (size_t i = 0; i < blockSize; ++i)
+                    {
+                        push(first[i]);
+                    }
+                }
+                first += blockSize;
+            }
+        }
+        for (; first != last; ++first)
+        {
+            push(*first);
+        }
+    }
+
+    // Folds other's elements into this selector.
+    void merge(TopK other)
+    { // O(K log(K))
+        std::vector<T> values;
+        values.reserve(other.size());
+        other.heap.pop_n(other.size(), std::back_inserter(values));
+        push_batch(values.begin(), values.end());
+    }
+
+    // Empties the selector; the best element comes first.
+    std::vector<T> take_sorted()
+    { // O(K log(K))
+        std::vector<T> values;
+        values.reserve(heap.size());
+        heap.pop_n(heap.size(), std::back_inserter(values));
+        std::reverse(values.begin(), values.end());
+        return values;
+    }
+};
+
+// Splits [first, last) across threadCount threads, selects a partial top-k in
+// each and merges the partials.
+template <typename RandomIt, typename Compare = std::less<>, typename Projection = Identity>
+TopK<typename std::iterator_traits<RandomIt>::value_type, Compare, Projection>
+selectTopK(RandomIt first, RandomIt last, size_t k, size_t threadCount,
+           Compare compare = Compare(), Projection projection = Projection())
+{
+    using Selector = TopK<typename std::iterator_traits<RandomIt>::value_type, Compare, Projection>;
+
+    const size_t total = static_cast<size_t>(last - first);
+    threadCount = std::max<size_t>(1, std::min(threadCount, total / 4096 + 1));
+
+    std::vector<Selector> partials(threadCount, Selector(k, compare, projection));
+    std::vector<std::thread> workers;
+    for (size_t part = 1; part < threadCount; ++part)
+    {
+        workers.emplace_back([&, part]
+                             { partials[part].push_batch(first + total * part / threadCount,
+                                                         first + total * (part + 1) / threadCount); });
+    }
+    partials[0].push_batch(first, first + total / threadCount);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (size_t part = 1; part < threadCount; ++part)
+    {
+        partials[0].merge(std::move(partials[part]));
+    }
+    return std::move(partials[0]);
+}
+
 struct Point
 {
     int x{};
     int y{};
 
-    double dist() const
+    long long distSquared() const
     {
-        return std::sqrt(x * x + y * y);
+        return 1LL * x * x + 1LL * y * y;
     }
 
     friend bool operator<(const Point &lhs, const Point &rhs)
     {
-        if (lhs.dist() < rhs.dist())
+        if (lhs.distSquared() < rhs.distSquared())
         {
             return true;
         }
@@ -120,37 +473,123 @@ struct Point
     }
 };
 
+struct SquaredDistance
+{
+    long long operator()(const Point &point) const
+    {
+        return point.distSquared();
+    }
+};
+
+// Parses whitespace-separated integers from large reads instead of one
+// formatted extraction per value.
+class IntReader
+{
+private:
+    std::istream &in;
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t length = 0;
+
+    bool refill()
+    {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        length = static_cast<size_t>(in.gcount());
+        position = 0;
+        return length > 0;
+    }
+
+    // Returns the next char without consuming it, or -1 at end of input.
+    int peek()
+    {
+        if (position == length && !refill())
+        {
+            return -1;
+        }
+        return static_cast<unsigned char>(buffer[position]);
+    }
+
+public:
+    explicit IntReader(std::istream &in_, size_t bufferBytes = 1 << 16)
+        : in(in_), buffer(std::max<size_t>(bufferBytes, 1)) {}
+
+    bool next(int &value)
+    {
+        int c = peek();
+        while (c != -1 && std::isspace(c))
+        {
+            ++position;
+            c = peek();
+        }
+        if (c == -1)
+        {
+            return false;
+        }
+
+        bool negative = false;
+        if (c == '-' || c == '+')
+        {
+            negative = c == '-';
+            ++position;
+            c = peek();
+        }
+        if (c == -1 || !std::isdigit(c))
+        {
+            return false;
+        }
+        // Fails like std::cin on a value outside int instead of wrapping.
+        const long long bound = negative ? -static_cast<long long>(std::numeric_limits<int>::min())
+                                         : std::numeric_limits<int>::max();
+        long long result = 0;
+        while (c != -1 && std::isdigit(c))
+        {
+            result = result * 10 + (c - '0');
+            if (result > bound)
+            {
+                return false;
+            }
+            ++position;
+            c = peek();
+        }
+        value = static_cast<int>(negative ? -result : result);
+        return true;
+    }
+};
+
+#ifndef TASK2_NO_MAIN
 int main()
 {
-    PriorityQueue<Point> pq;
+    IntReader reader(std::cin);
     int n, k;
-    std::cin >> n;
-    std::cin >> k;
-    int count = k;
-    while (count > 0)
+    if (!reader.next(n) || !reader.next(k))
     {
-        int x, y;
-        std::cin >> x >> y;
-        Point p{x, y};
-        pq.push(p);
-        --count;
+        return 0;
     }
 
-    for (int i = k + 1; i <= n; ++i)
+    TopK<Point, std::less<>, SquaredDistance> closest(k);
+    std::vector<Point> batch;
+    batch.reserve(4096);
+    for (int i = 0; i < n; ++i)
     {
-        int x, y;
-        std::cin >> x >> y;
-        Point p{x, y};
-        if (p < pq.top())
+        Point p;
+        if (!reader.next(p.x) || !reader.next(p.y))
+        {
+            break;
+        }
+        batch.push_back(p);
+        if (batch.size() == batch.capacity())
         {
-            pq.pop();
-            pq.push(p);
+            closest.push_batch(batch.begin(), batch.end());
+            batch.clear();
         }
     }
+    closest.push_batch(batch.begin(), batch.end());
 
-    while (!pq.empty())
+    // Farthest first, as the heap pops them.
+    std::vector<Point> points = closest.take_sorted();
+    for (auto it = points.rbegin(); it != points.rend(); ++it)
     {
-        std::cout << "[" << pq.top().x << ", " << pq.top().y << "] ";
-        pq.pop();
+        std::cout << "[" << it->x << ", " << it->y << "] ";
     }
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,374 @@
+// Benchmarks for PriorityQueue and TopK in task2.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread task2_bench.cpp -o task2_bench
+//   ./task2_bench [section] [size]
+//
+// Without arguments every section runs at its default size; a section name
+// runs only that section, optionally at another size.
+
+#define TASK2_NO_MAIN
+#include "task2.cpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <string>
+
+template <typename Body>
+double secondsFor(Body body)
+{
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps results observable so the timed work is not optimized away.
+static size_t sink = 0;
+
+// n pseudo-random ints from a xorshift generator.
+std::vector<int> randomInts(size_t n, uint64_t seed)
+{
+    std::vector<int> values(n);
+    for (int &value : values)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        value = static_cast<int>(seed >> 33);
+    }
+    return values;
+}
+
+// Building a heap of n ints: one push per element against the range
+// constructor's Floyd heapify, with std::make_heap for reference. Ascending
+// input is the worst case for pushes, since every element rises to the top.
+void benchBuild(size_t n)
+{
+    const std::vector<int> shuffled = randomInts(n, 88172645463325252ull);
+    std::vector<int> ascending(shuffled);
+    std::sort(ascending.begin(), ascending.end());
+
+    auto build = [&](const char *order, const std::vector<int> &values)
+    {
+        const double pushes = secondsFor([&]
+                                         {
+            PriorityQueue<int> heap;
+            for (int value : values)
+            {
+                heap.push(value);
+            }
+            sink += static_cast<size_t>(heap.top()); });
+        const double floyd = secondsFor([&]
+                                        {
+            PriorityQueue<int> heap(values.begin(), values.end());
+            sink += static_cast<size_t>(heap.top()); });
+        const double standard = secondsFor([&]
+                                           {
+            std::vector<int> heap(values);
+            std::make_heap(heap.begin(), heap.end());
+            sink += static_cast<size_t>(heap.front()); });
+        std::printf("build     %zu %-9s ints: push %.2f s, range constructor %.2f s, copy + std::make_heap %.2f s\n",
+                    n, order, pushes, floyd, standard);
+    };
+    build("random", shuffled);
+    build("ascending", ascending);
+}
+
+// The k-closest loop over n keys with k = 1000: pop then push for every
+// candidate that beats the top, against a single replace_top. Random keys
+// rarely beat the top once the heap has settled; in descending order every
+// key does.
+void benchReplace(size_t n)
+{
+    const size_t k = 1000;
+    auto select = [&](const char *order, const std::vector<int> &values)
+    {
+        const double popPush = secondsFor([&]
+                                          {
+            PriorityQueue<int> heap(values.begin(), values.begin() + k);
+            for (size_t i = k; i < n; ++i)
+            {
+                if (values[i] < heap.top())
+                {
+                    heap.pop();
+                    heap.push(values[i]);
+                }
+            }
+            sink += static_cast<size_t>(heap.top()); });
+        const double replaced = secondsFor([&]
+                                           {
+            PriorityQueue<int> heap(values.begin(), values.begin() + k);
+            for (size_t i = k; i < n; ++i)
+            {
+                if (values[i] < heap.top())
+                {
+                    heap.replace_top(values[i]);
+                }
+            }
+            sink += static_cast<size_t>(heap.top()); });
+        std::printf("replace   %zu %-10s keys, k=%zu: pop + push %.3f s, replace_top %.3f s\n", n, order, k,
+                    popPush, replaced);
+    };
+
+    std::vector<int> values = randomInts(n, 2463534242ull);
+    select("random", values);
+    std::sort(values.begin(), values.end(), std::greater<>());
+    select("descending", values);
+}
+
+// Pushes n random ints and pops them all, printing the best of three runs
+// in ns per element.
+template <typename Heap>
+void pushPopAll(const char *name, const std::vector<int> &values)
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run)
+    {
+        const double seconds = secondsFor([&]
+                                          {
+            Heap heap;
+            for (int value : values)
+            {
+                heap.push(value);
+            }
+            size_t checksum = 0;
+            while (!heap.empty())
+            {
+                checksum += static_cast<size_t>(heap.top());
+                heap.pop();
+            }
+            sink += checksum; });
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    std::printf("arity     %-26s %.1f ns per push + pop\n", name,
+                best * 1e9 / static_cast<double>(values.size()));
+}
+
+// Push and pop throughput of 2-, 4- and 8-ary PriorityQueue against the
+// binary std::priority_queue on n random ints.
+void benchArity(size_t n)
+{
+    const std::vector<int> values = randomInts(n, 1181783497276652981ull);
+    std::printf("arity     %zu ints\n", n);
+    pushPopAll<std::priority_queue<int>>("std::priority_queue", values);
+    pushPopAll<PriorityQueue<int, std::less<>, Identity, 2>>("PriorityQueue, arity 2", values);
+    pushPopAll<PriorityQueue<int, std::less<>, Identity, 4>>("PriorityQueue, arity 4", values);
+    pushPopAll<PriorityQueue<int, std::less<>, Identity, 8>>("PriorityQueue, arity 8", values);
+}
+
+// Euclidean distance, the key Point::operator< used to compute with sqrt.
+struct Distance
+{
+    double operator()(const Point &point) const
+    {
+        return std::sqrt(static_cast<double>(point.distSquared()));
+    }
+};
+
+// Compares points the way Point::operator< did, with a sqrt per side.
+struct ByDistance
+{
+    bool operator()(const Point &lhs, const Point &rhs) const
+    {
+        return Distance()(lhs) < Distance()(rhs);
+    }
+};
+
+// Ordering n points by distance, with the key computed in every comparison
+// against projected once and cached next to the element: for the squared
+// distance, which costs two multiplies, and for the Euclidean distance.
+void benchProjection(size_t n)
+{
+    const std::vector<int> coordinates = randomInts(2 * n, 6364136223846793005ull);
+    std::vector<Point> points(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        points[i] = {coordinates[2 * i] % 100000, coordinates[2 * i + 1] % 100000};
+    }
+
+    auto drain = [&](auto heap)
+    {
+        return secondsFor([&]
+                          {
+            for (const Point &point : points)
+            {
+                heap.push(point);
+            }
+            while (!heap.empty())
+            {
+                sink += static_cast<size_t>(heap.top().x);
+                heap.pop();
+            } });
+    };
+    const double scale = 1e9 / static_cast<double>(n);
+    const double squared = drain(PriorityQueue<Point, std::less<>, Identity, 4>());
+    const double squaredCached = drain(PriorityQueue<Point, std::less<>, SquaredDistance, 4>());
+    std::printf("project   %zu points, 4-ary, squared distance: per comparison %.1f ns, cached %.1f ns per push + pop\n",
+                n, squared * scale, squaredCached * scale);
+    const double euclidean = drain(PriorityQueue<Point, ByDistance, Identity, 4>());
+    const double euclideanCached = drain(PriorityQueue<Point, std::less<>, Distance, 4>());
+    std::printf("project   %zu points, 4-ary, sqrt distance:    per comparison %.1f ns, cached %.1f ns per push + pop\n",
+                n, euclidean * scale, euclideanCached * scale);
+}
+
+// TopK::push_batch as it was first written: candidates are copied into a
+// block, their keys into a second one, and every key is projected again
+// from the top element after each replacement.
+template <typename T, typename Compare = std::less<>, typename Projection = Identity>
+class LegacyTopK
+{
+private:
+    using Key = std::decay_t<std::invoke_result_t<Projection &, const T &>>;
+    static constexpr size_t blockSize = 64;
+
+    size_t limit;
+    Compare compare;
+    Projection projection;
+    PriorityQueue<T, Compare, Projection, 4> heap;
+
+public:
+    explicit LegacyTopK(size_t k) : limit(k) {}
+
+    template <typename InputIt>
+    void push_batch(InputIt first, InputIt last)
+    {
+        while (first != last && heap.size() < limit)
+        {
+            heap.push(*first);
+            ++first;
+        }
+        if (first == last || limit == 0)
+        {
+            return;
+        }
+
+        std::array<T, blockSize> block;
+        std::array<Key, blockSize> keys;
+        Key threshold = projection(heap.top());
+        while (first != last)
+        {
+            size_t count = 0;
+            for (; count < blockSize && first != last; ++first, ++count)
+            {
+                block[count] = *first;
+            }
+            bool any = false;
+            for (size_t i = 0; i < count; ++i)
+            {
+                keys[i] = projection(block[i]);
+                any |= compare(keys[i], threshold);
+            }
+            if (!any)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (compare(keys[i], threshold))
+                {
+                    heap.replace_top(block[i]);
+                    threshold = projection(heap.top());
+                }
+            }
+        }
+    }
+
+    const T &top() const
+    {
+        return heap.top();
+    }
+};
+
+// Selecting the k = 100 points closest to the origin out of n: one push per
+// point, the copying LegacyTopK::push_batch, TopK::push_batch and
+// selectTopK over every hardware thread, checked against std::nth_element.
+void benchTopK(size_t n)
+{
+    const size_t k = 100;
+    const std::vector<int> coordinates = randomInts(2 * n, 1442695040888963407ull);
+    std::vector<Point> points(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        points[i] = {coordinates[2 * i] % 1000000 - 500000, coordinates[2 * i + 1] % 1000000 - 500000};
+    }
+
+    std::vector<long long> distances(n);
+    std::transform(points.begin(), points.end(), distances.begin(), SquaredDistance());
+    std::nth_element(distances.begin(), distances.begin() + (k - 1), distances.end());
+    const long long expected = distances[k - 1];
+
+    long long pushed = 0;
+    const double single = secondsFor([&]
+                                     {
+        TopK<Point, std::less<>, SquaredDistance> closest(k);
+        for (const Point &point : points)
+        {
+            closest.push(point);
+        }
+        pushed = closest.take_sorted().back().distSquared(); });
+    long long copied = 0;
+    const double legacy = secondsFor([&]
+                                     {
+        LegacyTopK<Point, std::less<>, SquaredDistance> closest(k);
+        closest.push_batch(points.begin(), points.end());
+        copied = closest.top().distSquared(); });
+    long long screened = 0;
+    const double batch = secondsFor([&]
+                                    {
+        TopK<Point, std::less<>, SquaredDistance> closest(k);
+        closest.push_batch(points.begin(), points.end());
+        screened = closest.take_sorted().back().distSquared(); });
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    long long parallel = 0;
+    const double split = secondsFor([&]
+                                    {
+        auto closest = selectTopK(points.begin(), points.end(), k, threads, std::less<>(), SquaredDistance());
+        parallel = closest.take_sorted().back().distSquared(); });
+
+    if (pushed != expected || copied != expected || screened != expected || parallel != expected)
+    {
+        std::printf("topk      wrong k-th distance: expected %lld, got %lld %lld %lld %lld\n", expected, pushed,
+                    copied, screened, parallel);
+        sink = 0;
+        return;
+    }
+    sink += static_cast<size_t>(expected);
+    const double scale = 1e9 / static_cast<double>(n);
+    std::printf("topk      %zu points, k=%zu: push %.2f ns, legacy push_batch %.2f ns, push_batch %.2f ns, "
+                "selectTopK (%zu threads) %.2f ns per point\n",
+                n, k, single * scale, legacy * scale, batch * scale, threads, split * scale);
+}
+
+int main(int argc, char **argv)
+{
+    const std::string only = argc > 1 ? argv[1] : "";
+    const size_t size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    auto wants = [&](const char *name)
+    { return only.empty() || only == name; };
+
+    if (wants("build"))
+    {
+        benchBuild(size != 0 ? size : 100000000);
+    }
+    if (wants("replace"))
+    {
+        benchReplace(size != 0 ? size : 100000000);
+    }
+    if (wants("arity"))
+    {
+        benchArity(size != 0 ? size : 10000000);
+    }
+    if (wants("project"))
+    {
+        benchProjection(size != 0 ? size : 10000000);
+    }
+    if (wants("topk"))
+    {
+        benchTopK(size != 0 ? size : 100000000);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
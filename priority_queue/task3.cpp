@@ -1,36 +1,151 @@
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template <typename T>
+// Projection that orders elements by themselves; no key is cached for it.
+struct Identity
+{
+    template <typename U>
+    const U &operator()(const U &value) const
+    {
+        return value;
+    }
+};
+
+// Heap whose top is the element with the greatest projected key under
+// Compare (std::less<> gives a max-heap, std::greater<> a min-heap). Keys are
+// projected once on insertion and stored next to their element. Arity sets
+// the number of children per node; 4 or 8 make sift-down shallower and keep
+// the children it scans in one cache line.
+template <typename T, typename Compare = std::less<>, typename Projection = Identity, size_t Arity = 2>
 class PriorityQueue
 {
+    static_assert(Arity >= 2, "PriorityQueue needs at least two children per node");
+
 private:
-    std::vector<T> heap;
+    using Key = std::decay_t<std::invoke_result_t<Projection &, const T &>>;
+    static constexpr bool cachesKey = !std::is_same_v<Projection, Identity>;
 
-public:
-    template <typename InputIt>
-    PriorityQueue(InputIt first, InputIt last)
+    struct KeyedEntry
+    {
+        Key key;
+        T value;
+    };
+    using Entry = std::conditional_t<cachesKey, KeyedEntry, T>;
+
+    std::vector<Entry> heap;
+    Compare compare;
+    Projection projection;
+
+    static const auto &keyOf(const Entry &entry)
     {
-        while (first != last)
+        if constexpr (cachesKey)
         {
-            heap.push(*first);
-            ++first;
+            return entry.key;
         }
-        for (int index = heap.size() / 2 - 1; index >= 0; --index)
+        else
         {
-            int child = 2 * index + 1;
-            if (child + 1 < heap.size() && heap[child + 1] > heap[child])
-            {
-                ++child;
-            }
-            if (heap[child] > heap[index])
+            return entry;
+        }
+    }
+
+    static const T &valueOf(const Entry &entry)
+    {
+        if constexpr (cachesKey)
+        {
+            return entry.value;
+        }
+        else
+        {
+            return entry;
+        }
+    }
+
+    Entry makeEntry(const T &value)
+    {
+        if constexpr (cachesKey)
+        {
+            return Entry{projection(value), value};
+        }
+        else
+        {
+            return value;
+        }
+    }
+
+    // True when lhs belongs below rhs.
+    bool lower(const Entry &lhs, const Entry &rhs) const
+    {
+        return compare(keyOf(lhs), keyOf(rhs));
+    }
+
+    void siftUp(size_t index)
+    {
+        Entry entry = std::move(heap[index]);
+        while (index > 0 && lower(heap[(index - 1) / Arity], entry))
+        {
+            heap[index] = std::move(heap[(index - 1) / Arity]);
+            index = (index - 1) / Arity;
+        }
+        heap[index] = std::move(entry);
+    }
+
+    // Moves the hole at index down to a leaf along the best children, then
+    // lets the displaced entry rise from there. The elements popped from the
+    // bottom usually belong near the leaves, so this skips most comparisons
+    // against the entry itself.
+    void siftDown(size_t index)
+    {
+        const size_t start = index;
+        const size_t count = heap.size();
+        Entry entry = std::move(heap[index]);
+        while (Arity * index + 1 < count)
+        {
+            const size_t firstChild = Arity * index + 1;
+            const size_t lastChild = std::min(firstChild + Arity, count);
+            size_t bestChild = firstChild;
+            for (size_t child = firstChild + 1; child < lastChild; ++child)
             {
-                std::swap(heap[index], heap[child]);
+                if (lower(heap[bestChild], heap[child]))
+                {
+                    bestChild = child;
+                }
             }
+            heap[index] = std::move(heap[bestChild]);
+            index = bestChild;
         }
+        while (index > start && lower(heap[(index - 1) / Arity], entry))
+        {
+            heap[index] = std::move(heap[(index - 1) / Arity]);
+            index = (index - 1) / Arity;
+        }
+        heap[index] = std::move(entry);
     }
 
-    PriorityQueue() = default;
+    // Floyd's bottom-up construction, O(N).
+    void heapify()
+    {
+        for (size_t index = (heap.size() + Arity - 2) / Arity; index > 0; --index)
+        {
+            siftDown(index - 1);
+        }
+    }
+
+public:
+    template <typename InputIt>
+    PriorityQueue(InputIt first, InputIt last, Compare compare_ = Compare(), Projection projection_ = Projection())
+        : compare(std::move(compare_)), projection(std::move(projection_))
+    { // O(N)
+        push_range(first, last);
+    }
+
+    explicit PriorityQueue(Compare compare_ = Compare(), Projection projection_ = Projection())
+        : compare(std::move(compare_)), projection(std::move(projection_)) {}
 
     bool empty() const
     { // O(1)
@@ -48,12 +163,38 @@ public:
 
     void push(const T &value)
     { // O(log(N))
-        heap.push_back(value);
-        int index = heap.size() - 1;
-        while (index > 0 && heap[(index - 1) / 2] < value)
+        heap.push_back(makeEntry(value));
+        siftUp(heap.size() - 1);
+    }
+
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last)
+    { // O(K log(N)) or O(N + K), whichever is smaller
+        const size_t oldSize = heap.size();
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+        {
+            heap.reserve(oldSize + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first)
+        {
+            heap.push_back(makeEntry(*first));
+        }
+        const size_t added = heap.size() - oldSize;
+
+        size_t depth = 0;
+        for (size_t count = heap.size(); count > 1; count /= Arity)
+        {
+            ++depth;
+        }
+        if (added * depth >= heap.size())
+        {
+            heapify();
+            return;
+        }
+        for (size_t index = oldSize; index < heap.size(); ++index)
         {
-            std::swap(heap[index], heap[(index - 1) / 2]);
-            index = (index - 1) / 2;
+            siftUp(index);
         }
     }
 
@@ -64,29 +205,45 @@ public:
             return;
         }
 
-        std::swap(heap[0], heap[size() - 1]);
+        heap[0] = std::move(heap.back());
         heap.pop_back();
-        int index = 0;
-
-        while (2 * index + 1 < size())
+        if (!empty())
         {
-            int largestChild = 2 * index + 1;
-
-            if (largestChild + 1 < size() && heap[largestChild + 1] > heap[largestChild])
-            {
-                largestChild = largestChild + 1;
-            }
+            siftDown(0);
+        }
+    }
 
-            if (heap[largestChild] > heap[index])
+    // Moves up to count top elements to out, in pop order.
+    template <typename OutputIt>
+    OutputIt pop_n(size_t count, OutputIt out)
+    { // O(K log(N))
+        while (count > 0 && !empty())
+        {
+            if constexpr (cachesKey)
             {
-                std::swap(heap[index], heap[largestChild]);
-                index = largestChild;
+                *out = std::move(heap[0].value);
             }
             else
             {
-                break;
+                *out = std::move(heap[0]);
             }
+            ++out;
+            pop();
+            --count;
         }
+        return out;
+    }
+
+    // Same as pop() followed by push(value), with a single sift.
+    void replace_top(const T &value)
+    { // O(log(N))
+        if (empty())
+        {
+            push(value);
+            return;
+        }
+        heap[0] = makeEntry(value);
+        siftDown(0);
     }
 
     const T &top() const
@@ -95,7 +252,17 @@ public:
         {
             throw std::out_of_range("PriorityQueue is empty");
         }
-        return heap[0];
+        return valueOf(heap[0]);
+    }
+
+    // Projected key of top(), read from the cache instead of recomputed.
+    const Key &top_key() const
+    { // O(1)
+        if (empty())
+        {
+            throw std::out_of_range("PriorityQueue is empty");
+        }
+        return keyOf(heap[0]);
     }
 };
 
@@ -114,16 +281,17 @@ int main()
     int ladders;
     std::cin >> ladders;
 
-    PriorityQueue<int> pq;
+    // Climbs paid with ladders, smallest on top.
+    PriorityQueue<int, std::greater<>> pq;
     for (int i = 0; i < n - 1; ++i)
     {
         int diff = heights[i + 1] - heights[i];
         if (diff > 0)
         {
-            pq.push(-diff);
+            pq.push(diff);
             if (pq.size() > ladders)
             {
-                bricks += pq.top();
+                bricks -= pq.top();
                 pq.pop();
             }
             if (bricks < 0)
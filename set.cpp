@@ -1,5 +1,29 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SET_AVX2_DISPATCH 1
+#else
+#define SET_AVX2_DISPATCH 0
+#endif
+
+#if defined(__GNUC__)
+#define SET_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define SET_ALWAYS_INLINE inline
+#endif
 
 template <typename T>
 class Set
@@ -13,13 +37,235 @@ class Set
 
         int height{};
         int balanceFactor{};
+        size_t subtreeSize{1};
 
         explicit Node(T value_) noexcept : value(value_), left(nullptr), right(nullptr), parent(nullptr) {}
     };
 
+    // Slab allocator owned by the set. Nodes are carved out of slabs that
+    // double in size, erased nodes are kept on a free list for reuse and all
+    // slabs are released at once when the pool goes away. Whole subtrees can
+    // be discarded in O(1): they are taken apart one node per allocation, as
+    // their slots are reused.
+    class NodePool
+    {
+        union Slot
+        {
+            Slot *next;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        static constexpr size_t firstSlabSize = 64;
+        static constexpr size_t maxSlabSize = 1 << 16;
+
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        Slot *cursor{};
+        Slot *slabEnd{};
+        Slot *freeList{};
+        size_t nextSlabSize{firstSlabSize};
+        // Discarded subtrees, linked through their roots' parent pointers.
+        Node *deadHead{};
+        Node *deadTail{};
+
+        // Detaches the first discarded root, queueing its children in its
+        // place, and ends its lifetime.
+        Node *takeDead() noexcept
+        {
+            Node *node = deadHead;
+            deadHead = node->parent;
+            if (deadHead == nullptr)
+                deadTail = nullptr;
+            for (Node *child : {node->left, node->right})
+            {
+                if (child == nullptr)
+                    continue;
+                child->parent = deadHead;
+                deadHead = child;
+                if (deadTail == nullptr)
+                    deadTail = child;
+            }
+            node->~Node();
+            return node;
+        }
+
+        void releaseDead() noexcept
+        {
+            if constexpr (std::is_trivially_destructible_v<T>)
+            {
+                deadHead = deadTail = nullptr;
+                return;
+            }
+            while (deadHead != nullptr)
+                takeDead();
+        }
+
+        Slot *takeSlot()
+        {
+            if (freeList != nullptr)
+            {
+                Slot *slot = freeList;
+                freeList = slot->next;
+                return slot;
+            }
+            if (deadHead != nullptr)
+                return reinterpret_cast<Slot *>(takeDead());
+            if (cursor == slabEnd)
+            {
+                addSlab(nextSlabSize);
+                nextSlabSize = std::min(nextSlabSize * 2, maxSlabSize);
+            }
+            return cursor++;
+        }
+
+        void addSlab(size_t count)
+        {
+            slabs.emplace_back(new Slot[count]);
+            cursor = slabs.back().get();
+            slabEnd = cursor + count;
+        }
+
+    public:
+        NodePool() = default;
+
+        NodePool(NodePool &&other) noexcept
+            : slabs(std::move(other.slabs)), cursor(other.cursor), slabEnd(other.slabEnd),
+              freeList(other.freeList), nextSlabSize(other.nextSlabSize), deadHead(other.deadHead),
+              deadTail(other.deadTail)
+        {
+            other.cursor = other.slabEnd = other.freeList = nullptr;
+            other.nextSlabSize = firstSlabSize;
+            other.deadHead = other.deadTail = nullptr;
+        }
+
+        NodePool &operator=(NodePool &&other) noexcept
+        {
+            if (this != &other)
+            {
+                releaseDead();
+                slabs = std::move(other.slabs);
+                cursor = other.cursor;
+                slabEnd = other.slabEnd;
+                freeList = other.freeList;
+                nextSlabSize = other.nextSlabSize;
+                deadHead = other.deadHead;
+                deadTail = other.deadTail;
+                other.cursor = other.slabEnd = other.freeList = nullptr;
+                other.nextSlabSize = firstSlabSize;
+                other.deadHead = other.deadTail = nullptr;
+            }
+            return *this;
+        }
+
+        ~NodePool()
+        {
+            releaseDead();
+        }
+
+        template <typename... Args>
+        Node *create(Args &&...args)
+        {
+            Slot *slot = takeSlot();
+            try
+            {
+                return ::new (slot->storage) Node(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                slot->next = freeList;
+                freeList = slot;
+                throw;
+            }
+        }
+
+        // Takes over all of other's slabs and free slots, leaving other empty.
+        // Whatever other had not carved out of its last slab yet stays unused
+        // until this pool is released.
+        void absorb(NodePool &other)
+        {
+            for (auto &slab : other.slabs)
+            {
+                slabs.push_back(std::move(slab));
+            }
+            other.slabs.clear();
+            if (other.freeList != nullptr)
+            {
+                Slot *last = other.freeList;
+                while (last->next != nullptr)
+                    last = last->next;
+                last->next = freeList;
+                freeList = other.freeList;
+            }
+            discard(other.deadHead, other.deadTail);
+            other.cursor = other.slabEnd = other.freeList = nullptr;
+            other.nextSlabSize = firstSlabSize;
+            other.deadHead = other.deadTail = nullptr;
+        }
+
+        // Makes the next count allocations come from one contiguous slab.
+        void reserve(size_t count)
+        {
+            if (freeList == nullptr && deadHead == nullptr && static_cast<size_t>(slabEnd - cursor) < count)
+            {
+                addSlab(count);
+            }
+        }
+
+        void destroy(Node *node) noexcept
+        {
+            node->~Node();
+            Slot *slot = reinterpret_cast<Slot *>(node);
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+        // Takes the detached subtrees head..tail, chained through their
+        // roots' parent pointers, without visiting their nodes.
+        void discard(Node *head, Node *tail) noexcept
+        {
+            if (head == nullptr)
+                return;
+            tail->parent = deadHead;
+            deadHead = head;
+            if (deadTail == nullptr)
+                deadTail = tail;
+        }
+    };
+
+    NodePool pool;
     Node *root{};
     size_t size_{};
 
+    // Runs the node destructors of a whole subtree without recursion; the
+    // memory itself goes back with the pool.
+    void destroyTree(Node *node) noexcept
+    {
+        if constexpr (std::is_trivially_destructible_v<T>)
+        {
+            return;
+        }
+        while (node != nullptr)
+        {
+            if (node->left != nullptr)
+            {
+                node = node->left;
+            }
+            else if (node->right != nullptr)
+            {
+                node = node->right;
+            }
+            else
+            {
+                Node *parent = node->parent;
+                if (parent != nullptr)
+                {
+                    (parent->left == node ? parent->left : parent->right) = nullptr;
+                }
+                node->~Node();
+                node = parent;
+            }
+        }
+    }
+
     void updateHeight(Node* node) noexcept
     {
         int leftHeight = (node->left != nullptr) ? node->left->height : -1;
@@ -39,243 +285,1683 @@ class Set
         node->balanceFactor = getBalanceFactor(node);
     }
 
-    void insert_recursively(Node *&current, const T &value) noexcept
+    static size_t subtreeSize(Node *node) noexcept
+    {
+        return node != nullptr ? node->subtreeSize : 0;
+    }
+
+    void updateNode(Node *node) noexcept
+    {
+        updateHeight(node);
+        updateBalanceFactor(node);
+        node->subtreeSize = 1 + subtreeSize(node->left) + subtreeSize(node->right);
+    }
+
+    // First node whose value is not less than value (or, when strict, greater
+    // than value); nullptr if there is none.
+    Node *boundNode(const T &value, bool strict) const noexcept
     {
-        if (!current)
+        Node *current = root;
+        Node *bound = nullptr;
+        while (current != nullptr)
         {
-            current = new Node(value);
-            ++size_;
-            return;
+            if (strict ? value < current->value : !(current->value < value))
+            {
+                bound = current;
+                current = current->left;
+            }
+            else
+            {
+                current = current->right;
+            }
+        }
+        return bound;
+    }
+
+    // Number of elements less than value (or, when strict, not greater).
+    size_t countBelow(const T &value, bool strict) const noexcept
+    {
+        Node *current = root;
+        size_t count = 0;
+        while (current != nullptr)
+        {
+            if (strict ? value < current->value : !(current->value < value))
+            {
+                current = current->left;
+            }
+            else
+            {
+                count += subtreeSize(current->left) + 1;
+                current = current->right;
+            }
         }
+        return count;
+    }
 
-        if (value < current->value)
+    void replaceChild(Node *parent, Node *child, Node *replacement) noexcept
+    {
+        if (parent == nullptr)
         {
-            insert_recursively(current->left, value);
-            current->left->parent = current;
+            root = replacement;
         }
-        else if (value >= current->value && current->value >= value)
+        else if (parent->left == child)
         {
-            return;
+            parent->left = replacement;
         }
         else
         {
-            insert_recursively(current->right, value);
-            current->right->parent = current;
+            parent->right = replacement;
         }
-
-        updateHeight(current);
-        updateBalanceFactor(current);
     }
 
-    void inorder_traversal(Node *node) noexcept
+    // Rotations only rewire the subtree: the pivot inherits node's parent
+    // pointer, but linking it into that parent is left to the caller.
+    Node *rotateLeft(Node *node) noexcept
     {
-        if (node != nullptr)
+        Node *pivot = node->right;
+        node->right = pivot->left;
+        if (pivot->left != nullptr)
         {
-            inorder_traversal(node->left);
-            std::cout << node->value << " ";
-            inorder_traversal(node->right);
+            pivot->left->parent = node;
         }
+        pivot->parent = node->parent;
+        pivot->left = node;
+        node->parent = pivot;
+        updateNode(node);
+        updateNode(pivot);
+        return pivot;
     }
 
-public:
-    void insert(const T &value)
-    {
-        insert_recursively(root, value);
-    };
-
-    void print_inorder()
+    Node *rotateRight(Node *node) noexcept
     {
-        inorder_traversal(root);
-        std::cout << "\n";
-    };
+        Node *pivot = node->left;
+        node->left = pivot->right;
+        if (pivot->right != nullptr)
+        {
+            pivot->right->parent = node;
+        }
+        pivot->parent = node->parent;
+        pivot->right = node;
+        node->parent = pivot;
+        updateNode(node);
+        updateNode(pivot);
+        return pivot;
+    }
 
-    struct iterator
+    // Restores the AVL invariant at node and returns the new root of its
+    // subtree, without linking it into node's parent.
+    Node *rebalanceSubtree(Node *node) noexcept
     {
-    public:
-        Node *current;
-
-        using value_type = T;
-        using reference = T &;
-        using pointer = T *;
-        using difference_type = std::ptrdiff_t;
-        using iterator_category = std::forward_iterator_tag;
-
-        explicit iterator() noexcept : iterator(nullptr) {}
-
-        explicit iterator(Node *node) noexcept : current(node) {}
-
-        auto findSuccessor(Node *node) -> Node *
+        updateNode(node);
+        if (node->balanceFactor > 1)
         {
-            if (node == nullptr)
-                return nullptr;
-
-            if (node->right != nullptr)
+            if (node->left->balanceFactor < 0)
             {
-                Node *successor = node->right;
-                while (successor->left != nullptr)
-                {
-                    successor = successor->left;
-                }
-                return successor;
+                node->left = rotateLeft(node->left);
             }
-            else
+            return rotateRight(node);
+        }
+        if (node->balanceFactor < -1)
+        {
+            if (node->right->balanceFactor > 0)
             {
-                Node *ancestor = node->parent;
-                Node *presentNode = node;
-
-                while (ancestor != nullptr && current == ancestor->right)
-                {
-                    current = ancestor;
-                    ancestor = ancestor->parent;
-                }
-                return ancestor;
+                node->right = rotateRight(node->right);
             }
+            return rotateLeft(node);
         }
+        return node;
+    }
 
-        reference operator*() const
+    // Restores the AVL invariant at node and returns the root of its subtree.
+    Node *rebalance(Node *node) noexcept
+    {
+        Node *parent = node->parent;
+        Node *subtree = rebalanceSubtree(node);
+        if (subtree != node)
         {
-            return current->value;
+            replaceChild(parent, node, subtree);
         }
+        return subtree;
+    }
 
-        pointer operator->() const
+    // Walks the parent chain up to the root, fixing heights and rotating
+    // wherever a subtree became unbalanced.
+    void rebalanceFrom(Node *node) noexcept
+    {
+        while (node != nullptr)
         {
-            return &(current->value);
+            node = rebalance(node)->parent;
         }
+    }
 
-        iterator &operator++()
-        {
-            current = findSuccessor(current);
-            return (*this);
-        }
+    // Builds a perfectly balanced subtree from the next count distinct values
+    // of a sorted range. Nodes are created in order, so with a reserved pool
+    // the in-order sequence is also the memory order.
+    template <typename ForwardIt>
+    Node *buildBalanced(ForwardIt &first, ForwardIt last, size_t count)
+    {
+        if (count == 0)
+            return nullptr;
 
-        iterator operator++(int)
+        const size_t leftCount = count / 2;
+        Node *left = buildBalanced(first, last, leftCount);
+        Node *node = pool.create(*first);
+        do
         {
-            iterator temp = *this;
-            ++(*this);
-            return temp;
-        }
+            ++first;
+        } while (first != last && !(node->value < *first));
 
-        friend bool operator==(iterator lhs, iterator rhs)
+        node->left = left;
+        node->right = buildBalanced(first, last, count - leftCount - 1);
+        if (node->left != nullptr)
+            node->left->parent = node;
+        if (node->right != nullptr)
+            node->right->parent = node;
+        updateNode(node);
+        return node;
+    }
+
+    // Subtrees dropped by the set operations, chained through the parent
+    // pointers of their roots so that concurrent branches never touch the
+    // pool; they are released once the operation has finished.
+    struct Garbage
+    {
+        Node *head{};
+        Node *tail{};
+
+        void push(Node *subtree) noexcept
         {
-            return lhs.current == rhs.current;
+            if (subtree == nullptr)
+                return;
+            subtree->parent = head;
+            head = subtree;
+            if (tail == nullptr)
+                tail = subtree;
         }
 
-        friend bool operator!=(iterator lhs, iterator rhs)
+        void append(Garbage &other) noexcept
         {
-            return lhs.current != rhs.current;
+            if (other.head == nullptr)
+                return;
+            other.tail->parent = head;
+            head = other.head;
+            if (tail == nullptr)
+                tail = other.tail;
         }
     };
 
-    iterator begin()
+    struct SplitResult
     {
-        if (!root)
+        Node *left;
+        Node *match;
+        Node *right;
+    };
+
+    using SetOperation = Node *(Set::*)(Node *, Node *, Garbage &, int);
+
+    static constexpr size_t parallelGrain = 1 << 15;
+
+    static int heightOf(Node *node) noexcept
+    {
+        return node != nullptr ? node->height : -1;
+    }
+
+    Node *attach(Node *node, Node *left, Node *right) noexcept
+    {
+        node->left = left;
+        node->right = right;
+        if (left != nullptr)
+            left->parent = node;
+        if (right != nullptr)
+            right->parent = node;
+        updateNode(node);
+        return node;
+    }
+
+    // Joins two detached trees around node, where every value in left is
+    // less than node's and every value in right is greater. Runs in
+    // O(|height(left) - height(right)|) by descending the taller spine.
+    Node *join(Node *left, Node *node, Node *right) noexcept
+    {
+        if (heightOf(left) > heightOf(right) + 1)
         {
-            return iterator(nullptr);
+            left->right = join(left->right, node, right);
+            left->right->parent = left;
+            return rebalanceSubtree(left);
+        }
+        if (heightOf(right) > heightOf(left) + 1)
+        {
+            right->left = join(left, node, right->left);
+            right->left->parent = right;
+            return rebalanceSubtree(right);
         }
+        return attach(node, left, right);
+    }
 
-        auto current = root;
-        while (current->left)
-            current = current->left;
+    // Joins two detached trees without a middle node.
+    Node *join(Node *left, Node *right) noexcept
+    {
+        if (left == nullptr)
+            return right;
 
-        return iterator(current);
+        Node *rest = nullptr;
+        Node *last = splitLast(left, rest);
+        return join(rest, last, right);
     }
 
-    iterator end()
+    // Detaches the largest node of a tree; rest receives the remaining tree.
+    Node *splitLast(Node *node, Node *&rest) noexcept
     {
-        return iterator(nullptr);
+        if (node->right == nullptr)
+        {
+            rest = node->left;
+            node->left = nullptr;
+            return node;
+        }
+        Node *remaining = nullptr;
+        Node *last = splitLast(node->right, remaining);
+        rest = join(node->left, node, remaining);
+        return last;
     }
 
-    iterator find(const T &value)
+    // Splits a detached tree into the values below value, the node equal to
+    // value (if any) and the values above it.
+    SplitResult split(Node *node, const T &value) noexcept
     {
-        auto current = root;
-        while (current)
+        if (node == nullptr)
+            return {nullptr, nullptr, nullptr};
+
+        Node *left = node->left;
+        Node *right = node->right;
+        if (value < node->value)
         {
-            if (value < current->value)
+            SplitResult parts = split(left, value);
+            parts.right = join(parts.right, node, right);
+            return parts;
+        }
+        if (node->value < value)
+        {
+            SplitResult parts = split(right, value);
+            parts.left = join(left, node, parts.left);
+            return parts;
+        }
+        node->left = nullptr;
+        node->right = nullptr;
+        return {left, node, right};
+    }
+
+    // Applies op to both halves, forking the left one onto another thread
+    // while forkDepth allows and both halves are big enough to pay for it.
+    std::pair<Node *, Node *> both(SetOperation op, Node *left1, Node *left2, Node *right1, Node *right2,
+                                   Garbage &garbage, int forkDepth)
+    {
+        if (forkDepth > 0 && subtreeSize(left1) + subtreeSize(left2) >= parallelGrain &&
+            subtreeSize(right1) + subtreeSize(right2) >= parallelGrain)
+        {
+            Garbage leftGarbage;
+            std::future<Node *> leftResult;
+            try
             {
-                current = current->left;
+                leftResult = std::async(std::launch::async, [&, left1, left2] {
+                    return (this->*op)(left1, left2, leftGarbage, forkDepth - 1);
+                });
             }
-            else if (value >= current->value && current->value >= value)
+            catch (const std::system_error &)
             {
-                return iterator(current);
+                forkDepth = 0;
             }
-            else
+            if (leftResult.valid())
             {
-                current = current->right;
+                Node *right = (this->*op)(right1, right2, garbage, forkDepth - 1);
+                Node *left = leftResult.get();
+                garbage.append(leftGarbage);
+                return {left, right};
             }
         }
-        return end();
+        Node *left = (this->*op)(left1, left2, garbage, 0);
+        Node *right = (this->*op)(right1, right2, garbage, 0);
+        return {left, right};
     }
 
-    void erase(iterator pos)
+    Node *unionOf(Node *first, Node *second, Garbage &garbage, int forkDepth)
     {
-        auto toBeErased = pos.current;
-        if (toBeErased == nullptr)
-            return;
+        if (first == nullptr)
+            return second;
+        if (second == nullptr)
+            return first;
+
+        SplitResult parts = split(second, first->value);
+        garbage.push(parts.match);
+        auto [left, right] = both(&Set::unionOf, first->left, parts.left, first->right, parts.right,
+                                  garbage, forkDepth);
+        return join(left, first, right);
+    }
 
-        if (toBeErased->left == nullptr && toBeErased->right == nullptr)
+    Node *intersectionOf(Node *first, Node *second, Garbage &garbage, int forkDepth)
+    {
+        if (first == nullptr || second == nullptr)
         {
-            if (toBeErased->parent != nullptr)
-            {
-                if (toBeErased->parent->left == toBeErased)
-                {
-                    toBeErased->parent->left = nullptr;
-                }
-                else
-                {
-                    toBeErased->parent->right = nullptr;
-                }
-            }
-            else
-            {
-                root = nullptr;
-            }
-            delete toBeErased;
-            --size_;
+            garbage.push(first);
+            garbage.push(second);
+            return nullptr;
+        }
+
+        SplitResult parts = split(second, first->value);
+        auto [left, right] = both(&Set::intersectionOf, first->left, parts.left, first->right, parts.right,
+                                  garbage, forkDepth);
+        if (parts.match == nullptr)
+        {
+            first->left = first->right = nullptr;
+            garbage.push(first);
+            return join(left, right);
+        }
+        garbage.push(parts.match);
+        return join(left, first, right);
+    }
+
+    Node *differenceOf(Node *first, Node *second, Garbage &garbage, int forkDepth)
+    {
+        if (first == nullptr || second == nullptr)
+        {
+            garbage.push(second);
+            return first;
+        }
+
+        SplitResult parts = split(first, second->value);
+        auto [left, right] = both(&Set::differenceOf, parts.left, second->left, parts.right, second->right,
+                                  garbage, forkDepth);
+        second->left = second->right = nullptr;
+        garbage.push(second);
+        garbage.push(parts.match);
+        return join(left, right);
+    }
+
+    // Runs op over both trees, adopting other's nodes and pool; other is
+    // left empty.
+    void combine(SetOperation op, Set &other)
+    {
+        pool.absorb(other.pool);
+        Node *otherRoot = other.root;
+        other.root = nullptr;
+        other.size_ = 0;
+
+        int forkDepth = 0;
+        for (unsigned threads = std::thread::hardware_concurrency(); threads > 1; threads = (threads + 1) / 2)
+            ++forkDepth;
+
+        Garbage garbage;
+        root = (this->*op)(root, otherRoot, garbage, forkDepth);
+        if (root != nullptr)
+            root->parent = nullptr;
+        size_ = subtreeSize(root);
+        pool.discard(garbage.head, garbage.tail);
+    }
+
+    void inorder_traversal(Node *node) noexcept
+    {
+        if (node != nullptr)
+        {
+            inorder_traversal(node->left);
+            std::cout << node->value << " ";
+            inorder_traversal(node->right);
+        }
+    }
+
+public:
+    Set() = default;
+
+    // Deep copy in O(n): the source is walked in order and bulk-loaded, so
+    // the copy is perfectly balanced and sits in a single slab.
+    Set(const Set &other)
+    {
+        Node *first = other.root;
+        while (first != nullptr && first->left != nullptr)
+            first = first->left;
+        assign_sorted(iterator(first), iterator(nullptr));
+    }
+
+    Set &operator=(const Set &other)
+    {
+        if (this != &other)
+            *this = Set(other);
+        return *this;
+    }
+
+    Set(Set &&other) noexcept : pool(std::move(other.pool)), root(other.root), size_(other.size_)
+    {
+        other.root = nullptr;
+        other.size_ = 0;
+    }
+
+    Set &operator=(Set &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroyTree(root);
+            pool = std::move(other.pool);
+            root = other.root;
+            size_ = other.size_;
+            other.root = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    // Accepts any range; sorted ranges are bulk-loaded in linear time, others
+    // fall back to one insert per element.
+    template <typename InputIt>
+    Set(InputIt first, InputIt last)
+    {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            if (std::is_sorted(first, last))
+            {
+                assign_sorted(first, last);
+                return;
+            }
+            for (; first != last; ++first)
+                insert(*first);
+        }
+        else
+        {
+            std::vector<T> values(first, last);
+            *this = Set(values.begin(), values.end());
+        }
+    }
+
+    // Replaces the contents with an ascending range (duplicates allowed) in
+    // O(n): the tree is built perfectly balanced from one slab of nodes.
+    template <typename ForwardIt>
+    void assign_sorted(ForwardIt first, ForwardIt last)
+    {
+        destroyTree(root);
+        root = nullptr;
+        size_ = 0;
+        pool = NodePool();
+
+        size_t count = 0;
+        for (ForwardIt it = first; it != last;)
+        {
+            ForwardIt next = it;
+            while (++next != last && !(*it < *next))
+            {
+            }
+            ++count;
+            it = next;
+        }
+
+        pool.reserve(count);
+        root = buildBalanced(first, last, count);
+        size_ = count;
+    }
+
+    void insert(const T &value)
+    {
+        Node *parent = nullptr;
+        Node **link = &root;
+        while (*link != nullptr)
+        {
+            parent = *link;
+            if (value < parent->value)
+            {
+                link = &parent->left;
+            }
+            else if (parent->value < value)
+            {
+                link = &parent->right;
+            }
+            else
+            {
+                return;
+            }
+        }
+
+        Node *node = pool.create(value);
+        node->parent = parent;
+        *link = node;
+        ++size_;
+        rebalanceFrom(parent);
+    };
+
+    void print_inorder()
+    {
+        inorder_traversal(root);
+        std::cout << "\n";
+    };
+
+    struct iterator
+    {
+    public:
+        Node *current;
+
+        using value_type = T;
+        using reference = T &;
+        using pointer = T *;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        explicit iterator() noexcept : iterator(nullptr) {}
+
+        explicit iterator(Node *node) noexcept : current(node) {}
+
+        auto findSuccessor(Node *node) -> Node *
+        {
+            if (node == nullptr)
+                return nullptr;
+
+            if (node->right != nullptr)
+            {
+                Node *successor = node->right;
+                while (successor->left != nullptr)
+                {
+                    successor = successor->left;
+                }
+                return successor;
+            }
+            else
+            {
+                Node *ancestor = node->parent;
+                Node *presentNode = node;
+
+                while (ancestor != nullptr && presentNode == ancestor->right)
+                {
+                    presentNode = ancestor;
+                    ancestor = ancestor->parent;
+                }
+                return ancestor;
+            }
+        }
+
+        reference operator*() const
+        {
+            return current->value;
+        }
+
+        pointer operator->() const
+        {
+            return &(current->value);
+        }
+
+        iterator &operator++()
+        {
+            current = findSuccessor(current);
+            return (*this);
+        }
+
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        friend bool operator==(iterator lhs, iterator rhs)
+        {
+            return lhs.current == rhs.current;
+        }
+
+        friend bool operator!=(iterator lhs, iterator rhs)
+        {
+            return lhs.current != rhs.current;
+        }
+    };
+
+    iterator begin()
+    {
+        if (!root)
+        {
+            return iterator(nullptr);
+        }
+
+        auto current = root;
+        while (current->left)
+            current = current->left;
+
+        return iterator(current);
+    }
+
+    iterator end()
+    {
+        return iterator(nullptr);
+    }
+
+    iterator find(const T &value)
+    {
+        auto current = root;
+        while (current)
+        {
+            if (value < current->value)
+            {
+                current = current->left;
+            }
+            else if (value >= current->value && current->value >= value)
+            {
+                return iterator(current);
+            }
+            else
+            {
+                current = current->right;
+            }
+        }
+        return end();
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    // Edges on the longest root-to-leaf path, -1 for an empty set.
+    int height() const
+    {
+        return root != nullptr ? root->height : -1;
+    }
+
+    iterator lower_bound(const T &value)
+    {
+        return iterator(boundNode(value, false));
+    }
+
+    iterator upper_bound(const T &value)
+    {
+        return iterator(boundNode(value, true));
+    }
+
+    // Number of elements less than value.
+    size_t rank(const T &value) const
+    {
+        return countBelow(value, false);
+    }
+
+    // The k-th smallest element (0-based), or end() if k >= size().
+    iterator select(size_t k)
+    {
+        Node *current = root;
+        while (current != nullptr)
+        {
+            const size_t leftSize = subtreeSize(current->left);
+            if (k < leftSize)
+            {
+                current = current->left;
+            }
+            else if (k == leftSize)
+            {
+                return iterator(current);
+            }
+            else
+            {
+                k -= leftSize + 1;
+                current = current->right;
+            }
+        }
+        return end();
+    }
+
+    // Number of elements in the closed range [lo, hi].
+    size_t count_range(const T &lo, const T &hi) const
+    {
+        if (hi < lo)
+            return 0;
+        return countBelow(hi, true) - countBelow(lo, false);
+    }
+
+    // Set algebra via split and join in O(m log(n / m + 1)) for sizes m <= n.
+    // Large inputs are split across threads. The other set's nodes are
+    // reused, so it is left empty. Dropped subtrees are handed to the pool
+    // whole and taken apart by later inserts, so the bound holds for the
+    // cleanup as well.
+    void unite(Set &other)
+    {
+        if (this != &other)
+            combine(&Set::unionOf, other);
+    }
+
+    void intersect(Set &other)
+    {
+        if (this != &other)
+            combine(&Set::intersectionOf, other);
+    }
+
+    void subtract(Set &other)
+    {
+        if (this == &other)
+        {
+            Set empty;
+            combine(&Set::intersectionOf, empty);
+            return;
+        }
+        combine(&Set::differenceOf, other);
+    }
+
+    void erase(iterator pos)
+    {
+        auto toBeErased = pos.current;
+        if (toBeErased == nullptr)
+            return;
+
+        if (toBeErased->left != nullptr && toBeErased->right != nullptr)
+        {
+            Node *successor = pos.findSuccessor(toBeErased);
+            toBeErased->value = std::move(successor->value);
+            toBeErased = successor;
+        }
+
+        Node *child = (toBeErased->left != nullptr) ? toBeErased->left : toBeErased->right;
+        Node *parent = toBeErased->parent;
+        replaceChild(parent, toBeErased, child);
+        if (child != nullptr)
+        {
+            child->parent = parent;
+        }
+        pool.destroy(toBeErased);
+        --size_;
+        rebalanceFrom(parent);
+    }
+
+    ~Set()
+    {
+        destroyTree(root);
+    }
+};
+
+// The operands are taken by value: sets passed with std::move are consumed
+// and their nodes reused, other sets are copied first and left untouched.
+template <typename T>
+Set<T> set_union(Set<T> lhs, Set<T> rhs)
+{
+    lhs.unite(rhs);
+    return lhs;
+}
+
+template <typename T>
+Set<T> set_intersection(Set<T> lhs, Set<T> rhs)
+{
+    lhs.intersect(rhs);
+    return lhs;
+}
+
+template <typename T>
+Set<T> set_difference(Set<T> lhs, Set<T> rhs)
+{
+    lhs.subtract(rhs);
+    return lhs;
+}
+
+// B-tree with up to B sorted keys per node, so a lookup touches one node per
+// level instead of one per key. Keys are stored by value in fixed arrays,
+// which suits small copyable keys such as integers.
+template <typename T, size_t B = 32>
+class BTreeSet
+{
+    static_assert(B >= 3, "BTreeSet needs at least three keys per node");
+
+    static constexpr size_t minKeys = (B - 1) / 2;
+
+    struct Node
+    {
+        size_t count{};
+        bool leaf{true};
+        Node *parent{};
+        T keys[B]{};
+        Node *children[B + 1]{};
+    };
+
+    Node *root{};
+    size_t size_{};
+
+    // Keys of node less than value, for arithmetic keys. The loop runs over
+    // all B slots and masks those past count, which are value-initialized,
+    // so its trip count is fixed and it has no branches; forced inline so
+    // each caller compiles it for its own target.
+    static SET_ALWAYS_INLINE size_t countLess(const Node *node, const T &value) noexcept
+    {
+        const unsigned count = static_cast<unsigned>(node->count);
+        unsigned less = 0;
+        for (unsigned i = 0; i < B; ++i)
+        {
+            less += (i < count) & (node->keys[i] < value);
+        }
+        return less;
+    }
+
+#if SET_AVX2_DISPATCH
+    // countLess compiled for AVX2, with eight 32-bit or four 64-bit keys per
+    // compare; baseline x86-64 has no 64-bit integer compare.
+    __attribute__((target("avx2"))) static size_t countLessAvx2(const Node *node, const T &value) noexcept
+    {
+        return countLess(node, value);
+    }
+
+    static bool cpuHasAvx2() noexcept
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+
+    // Index of the first key not less than value: a vectorized count for
+    // arithmetic keys, binary search for other types.
+    static size_t lowerBound(const Node *node, const T &value) noexcept
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+#if SET_AVX2_DISPATCH
+            if (cpuHasAvx2())
+            {
+                return countLessAvx2(node, value);
+            }
+#endif
+            return countLess(node, value);
+        }
+        else
+        {
+            return std::lower_bound(node->keys, node->keys + node->count, value) - node->keys;
+        }
+    }
+
+    static bool matches(const Node *node, size_t index, const T &value) noexcept
+    {
+        return index < node->count && !(value < node->keys[index]);
+    }
+
+    static void adopt(Node *node, size_t first, size_t last) noexcept
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            node->children[i]->parent = node;
+        }
+    }
+
+    static void destroy(Node *node) noexcept
+    {
+        if (node == nullptr)
             return;
+
+        if (!node->leaf)
+        {
+            for (size_t i = 0; i <= node->count; ++i)
+            {
+                destroy(node->children[i]);
+            }
+        }
+        delete node;
+    }
+
+    // Splits the full child at index into two nodes of at least minKeys keys
+    // and moves its median up into parent.
+    void split(Node *parent, size_t index)
+    {
+        Node *full = parent->children[index];
+        Node *right = new Node;
+        right->leaf = full->leaf;
+        right->parent = parent;
+
+        const size_t median = minKeys;
+        right->count = B - median - 1;
+        std::move(full->keys + median + 1, full->keys + B, right->keys);
+        if (!full->leaf)
+        {
+            std::copy(full->children + median + 1, full->children + B + 1, right->children);
+            adopt(right, 0, right->count + 1);
+        }
+        full->count = median;
+
+        std::move_backward(parent->keys + index, parent->keys + parent->count, parent->keys + parent->count + 1);
+        std::copy_backward(parent->children + index + 1, parent->children + parent->count + 1,
+                           parent->children + parent->count + 2);
+        parent->keys[index] = std::move(full->keys[median]);
+        parent->children[index + 1] = right;
+        ++parent->count;
+    }
+
+    // Folds the separator at index and the child to its right into the child
+    // to its left; collapses the root when it runs out of keys.
+    void merge(Node *parent, size_t index)
+    {
+        Node *left = parent->children[index];
+        Node *right = parent->children[index + 1];
+
+        left->keys[left->count] = std::move(parent->keys[index]);
+        std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+        if (!left->leaf)
+        {
+            std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+            adopt(left, left->count + 1, left->count + right->count + 2);
+        }
+        left->count += right->count + 1;
+
+        std::move(parent->keys + index + 1, parent->keys + parent->count, parent->keys + index);
+        std::copy(parent->children + index + 2, parent->children + parent->count + 1, parent->children + index + 1);
+        --parent->count;
+        delete right;
+
+        if (parent == root && parent->count == 0)
+        {
+            root = left;
+            left->parent = nullptr;
+            delete parent;
+        }
+    }
+
+    void borrowFromLeft(Node *parent, size_t index)
+    {
+        Node *child = parent->children[index];
+        Node *sibling = parent->children[index - 1];
+
+        std::move_backward(child->keys, child->keys + child->count, child->keys + child->count + 1);
+        child->keys[0] = std::move(parent->keys[index - 1]);
+        parent->keys[index - 1] = std::move(sibling->keys[sibling->count - 1]);
+        if (!child->leaf)
+        {
+            std::copy_backward(child->children, child->children + child->count + 1, child->children + child->count + 2);
+            child->children[0] = sibling->children[sibling->count];
+            child->children[0]->parent = child;
+        }
+        ++child->count;
+        --sibling->count;
+    }
+
+    void borrowFromRight(Node *parent, size_t index)
+    {
+        Node *child = parent->children[index];
+        Node *sibling = parent->children[index + 1];
+
+        child->keys[child->count] = std::move(parent->keys[index]);
+        parent->keys[index] = std::move(sibling->keys[0]);
+        std::move(sibling->keys + 1, sibling->keys + sibling->count, sibling->keys);
+        if (!child->leaf)
+        {
+            child->children[child->count + 1] = sibling->children[0];
+            child->children[child->count + 1]->parent = child;
+            std::copy(sibling->children + 1, sibling->children + sibling->count + 1, sibling->children);
+        }
+        ++child->count;
+        --sibling->count;
+    }
+
+    // Makes sure the child at index holds more than minKeys keys before the
+    // erase descends into it and returns the node to descend to.
+    Node *fill(Node *parent, size_t index)
+    {
+        if (index > 0 && parent->children[index - 1]->count > minKeys)
+        {
+            borrowFromLeft(parent, index);
+            return parent->children[index];
+        }
+        if (index < parent->count && parent->children[index + 1]->count > minKeys)
+        {
+            borrowFromRight(parent, index);
+            return parent->children[index];
+        }
+        if (index == parent->count)
+        {
+            --index;
+        }
+        Node *left = parent->children[index];
+        merge(parent, index);
+        return left;
+    }
+
+    // Single top-down pass: every node entered already has a spare key, so
+    // removing from a leaf never underflows.
+    void eraseValue(T value)
+    {
+        Node *node = root;
+        while (node != nullptr)
+        {
+            size_t index = lowerBound(node, value);
+            if (matches(node, index, value))
+            {
+                if (node->leaf)
+                {
+                    std::move(node->keys + index + 1, node->keys + node->count, node->keys + index);
+                    --node->count;
+                    --size_;
+                    if (node == root && node->count == 0)
+                    {
+                        delete root;
+                        root = nullptr;
+                    }
+                    return;
+                }
+
+                Node *left = node->children[index];
+                Node *right = node->children[index + 1];
+                if (left->count > minKeys)
+                {
+                    Node *predecessor = left;
+                    while (!predecessor->leaf)
+                        predecessor = predecessor->children[predecessor->count];
+                    node->keys[index] = predecessor->keys[predecessor->count - 1];
+                    value = node->keys[index];
+                    node = left;
+                }
+                else if (right->count > minKeys)
+                {
+                    Node *successor = right;
+                    while (!successor->leaf)
+                        successor = successor->children[0];
+                    node->keys[index] = successor->keys[0];
+                    value = node->keys[index];
+                    node = right;
+                }
+                else
+                {
+                    merge(node, index);
+                    node = left;
+                }
+                continue;
+            }
+
+            if (node->leaf)
+                return;
+
+            node = node->children[index]->count > minKeys ? node->children[index] : fill(node, index);
+        }
+    }
+
+public:
+    struct iterator
+    {
+    public:
+        Node *current;
+        size_t index;
+
+        using value_type = T;
+        using reference = const T &;
+        using pointer = const T *;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        explicit iterator(Node *node = nullptr, size_t index_ = 0) noexcept : current(node), index(index_) {}
+
+        reference operator*() const
+        {
+            return current->keys[index];
         }
 
-        if (toBeErased->left == nullptr || toBeErased->right == nullptr)
+        pointer operator->() const
+        {
+            return &(current->keys[index]);
+        }
+
+        iterator &operator++()
         {
-            auto child = (toBeErased->left != nullptr) ? toBeErased->left : toBeErased->right;
-            if (toBeErased->parent != nullptr)
+            if (!current->leaf)
+            {
+                current = current->children[index + 1];
+                while (!current->leaf)
+                    current = current->children[0];
+                index = 0;
+                return *this;
+            }
+
+            ++index;
+            while (current != nullptr && index >= current->count)
             {
-                if (toBeErased == toBeErased->parent->left)
+                Node *child = current;
+                current = current->parent;
+                if (current != nullptr)
                 {
-                    toBeErased->parent->left = child;
+                    index = std::find(current->children, current->children + current->count + 1, child) - current->children;
                 }
-                else
+            }
+            if (current == nullptr)
+                index = 0;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        friend bool operator==(iterator lhs, iterator rhs)
+        {
+            return lhs.current == rhs.current && lhs.index == rhs.index;
+        }
+
+        friend bool operator!=(iterator lhs, iterator rhs)
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    BTreeSet() = default;
+
+    BTreeSet(const BTreeSet &) = delete;
+    BTreeSet &operator=(const BTreeSet &) = delete;
+
+    BTreeSet(BTreeSet &&other) noexcept : root(other.root), size_(other.size_)
+    {
+        other.root = nullptr;
+        other.size_ = 0;
+    }
+
+    BTreeSet &operator=(BTreeSet &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy(root);
+            root = other.root;
+            size_ = other.size_;
+            other.root = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~BTreeSet()
+    {
+        destroy(root);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    void insert(const T &value)
+    {
+        if (root == nullptr)
+        {
+            root = new Node;
+        }
+        if (root->count == B)
+        {
+            Node *newRoot = new Node;
+            newRoot->leaf = false;
+            newRoot->children[0] = root;
+            root->parent = newRoot;
+            root = newRoot;
+            split(newRoot, 0);
+        }
+
+        Node *node = root;
+        while (true)
+        {
+            size_t index = lowerBound(node, value);
+            if (matches(node, index, value))
+                return;
+
+            if (node->leaf)
+            {
+                std::move_backward(node->keys + index, node->keys + node->count, node->keys + node->count + 1);
+                node->keys[index] = value;
+                ++node->count;
+                ++size_;
+                return;
+            }
+
+            if (node->children[index]->count == B)
+            {
+                split(node, index);
+                if (node->keys[index] < value)
+                {
+                    ++index;
+                }
+                else if (!(value < node->keys[index]))
+                {
+                    return;
+                }
+            }
+            node = node->children[index];
+        }
+    }
+
+    iterator begin()
+    {
+        if (root == nullptr || root->count == 0)
+            return end();
+
+        Node *current = root;
+        while (!current->leaf)
+            current = current->children[0];
+        return iterator(current, 0);
+    }
+
+    iterator end()
+    {
+        return iterator(nullptr, 0);
+    }
+
+    iterator find(const T &value)
+    {
+        Node *current = root;
+        while (current != nullptr)
+        {
+            size_t index = lowerBound(current, value);
+            if (matches(current, index, value))
+                return iterator(current, index);
+            if (current->leaf)
+                break;
+            current = current->children[index];
+        }
+        return end();
+    }
+
+    void erase(iterator pos)
+    {
+        if (pos.current == nullptr)
+            return;
+        eraseValue(*pos);
+    }
+};
+
+// AVL set for many concurrent readers. Nodes are immutable: a writer copies
+// the path it changes and publishes the new root atomically, so contains()
+// and for_each() never lock. Writers are serialized by a mutex. Nodes are
+// reference counted and shared between versions, which makes snapshot() O(1);
+// the reference a replaced root held is dropped through epochs once no
+// reader can still be walking it. Readers never block: past readerSlots
+// concurrent readers they are counted instead, and a writer about to drop
+// old roots waits for the counted readers that were already inside.
+template <typename T>
+class ConcurrentSet
+{
+    struct Node
+    {
+        const T value;
+        const Node *const left;
+        const Node *const right;
+        const int height;
+        const size_t size;
+        mutable std::atomic<size_t> references{1};
+
+        Node(const T &value_, const Node *left_, const Node *right_)
+            : value(value_), left(left_), right(right_),
+              height(1 + std::max(heightOf(left_), heightOf(right_))),
+              size(1 + sizeOf(left_) + sizeOf(right_)) {}
+    };
+
+    // Every active reader announces the epoch it entered in; a root retired
+    // in epoch e can be released once all announced epochs are greater than e.
+    static constexpr size_t readerSlots = 128;
+    static constexpr uint64_t idle = 0;
+    static constexpr size_t collectThreshold = 64;
+
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch{idle};
+    };
+
+    struct Retired
+    {
+        uint64_t epoch;
+        const Node *root;
+    };
+
+    std::atomic<const Node *> root{nullptr};
+    std::atomic<uint64_t> globalEpoch{1};
+    ReaderSlot slots[readerSlots];
+
+    // Readers that found every slot taken count themselves in the half
+    // overflowPhase selected when they came in.
+    std::atomic<size_t> overflowReaders[2]{};
+    std::atomic<unsigned> overflowPhase{0};
+
+    std::mutex writerMutex;
+    std::vector<Retired> retired;
+
+    // RAII announcement of a reader's epoch; claims a free slot, preferring
+    // the one this thread used last, or is counted in overflowReaders after
+    // one sweep over all slots.
+    class Guard
+    {
+        ConcurrentSet &set;
+        ReaderSlot *slot{};
+        unsigned phase{};
+
+    public:
+        explicit Guard(ConcurrentSet &set_) : set(set_)
+        {
+            static thread_local size_t hint = 0;
+            for (size_t attempt = 0; attempt < readerSlots; ++attempt)
+            {
+                const size_t index = (hint + attempt) % readerSlots;
+                uint64_t expected = idle;
+                if (set.slots[index].epoch.compare_exchange_strong(expected, set.globalEpoch.load()))
                 {
-                    toBeErased->parent->right = child;
+                    hint = index;
+                    slot = &set.slots[index];
+                    return;
                 }
-                child->parent = toBeErased->parent;
+            }
+            phase = set.overflowPhase.load();
+            set.overflowReaders[phase].fetch_add(1);
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard()
+        {
+            if (slot != nullptr)
+            {
+                slot->epoch.store(idle);
+                return;
+            }
+            set.overflowReaders[phase].fetch_sub(1);
+        }
+    };
+
+    static int heightOf(const Node *node) noexcept
+    {
+        return node != nullptr ? node->height : -1;
+    }
+
+    static size_t sizeOf(const Node *node) noexcept
+    {
+        return node != nullptr ? node->size : 0;
+    }
+
+    // Takes an extra reference to a node that stays shared.
+    static const Node *share(const Node *node) noexcept
+    {
+        if (node != nullptr)
+            node->references.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    static void release(const Node *node) noexcept
+    {
+        if (node != nullptr && node->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            release(node->left);
+            release(node->right);
+            delete node;
+        }
+    }
+
+    static bool contains(const Node *current, const T &value)
+    {
+        while (current != nullptr)
+        {
+            if (value < current->value)
+                current = current->left;
+            else if (current->value < value)
+                current = current->right;
+            else
+                return true;
+        }
+        return false;
+    }
+
+    template <typename Visitor>
+    static void visit(const Node *node, Visitor &visitor)
+    {
+        while (node != nullptr)
+        {
+            visit(node->left, visitor);
+            visitor(node->value);
+            node = node->right;
+        }
+    }
+
+    // The path-copying helpers below take ownership of the child references
+    // they are given and return an owned reference to the subtree they build.
+    static const Node *make(const T &value, const Node *left, const Node *right)
+    {
+        return new Node(value, left, right);
+    }
+
+    // Builds the node for value over left and right, rotating when their
+    // heights differ by two.
+    static const Node *balance(const T &value, const Node *left, const Node *right)
+    {
+        const Node *result;
+        if (heightOf(left) > heightOf(right) + 1)
+        {
+            if (heightOf(left->left) >= heightOf(left->right))
+            {
+                result = make(left->value, share(left->left), make(value, share(left->right), right));
+            }
+            else
+            {
+                const Node *inner = left->right;
+                result = make(inner->value, make(left->value, share(left->left), share(inner->left)),
+                              make(value, share(inner->right), right));
+            }
+            release(left);
+            return result;
+        }
+        if (heightOf(right) > heightOf(left) + 1)
+        {
+            if (heightOf(right->right) >= heightOf(right->left))
+            {
+                result = make(right->value, make(value, left, share(right->left)), share(right->right));
             }
             else
             {
-                root = child;
-                child->parent = nullptr;
+                const Node *inner = right->left;
+                result = make(inner->value, make(value, left, share(inner->left)),
+                              make(right->value, share(inner->right), share(right->right)));
             }
-            delete toBeErased;
-            --size_;
+            release(right);
+            return result;
+        }
+        return make(value, left, right);
+    }
+
+    // Returns the new subtree, or nullptr when value is already present.
+    static const Node *insertPath(const Node *node, const T &value)
+    {
+        if (node == nullptr)
+            return make(value, nullptr, nullptr);
+
+        if (value < node->value)
+        {
+            const Node *left = insertPath(node->left, value);
+            return left != nullptr ? balance(node->value, left, share(node->right)) : nullptr;
+        }
+        if (node->value < value)
+        {
+            const Node *right = insertPath(node->right, value);
+            return right != nullptr ? balance(node->value, share(node->left), right) : nullptr;
+        }
+        return nullptr;
+    }
+
+    static const Node *eraseMin(const Node *node, const Node *&minimum)
+    {
+        if (node->left == nullptr)
+        {
+            minimum = node;
+            return share(node->right);
+        }
+        const Node *left = eraseMin(node->left, minimum);
+        return balance(node->value, left, share(node->right));
+    }
+
+    // Returns the new subtree; only meaningful once erased is set.
+    static const Node *erasePath(const Node *node, const T &value, bool &erased)
+    {
+        if (node == nullptr)
+            return nullptr;
+
+        if (value < node->value)
+        {
+            const Node *left = erasePath(node->left, value, erased);
+            return erased ? balance(node->value, left, share(node->right)) : nullptr;
+        }
+        if (node->value < value)
+        {
+            const Node *right = erasePath(node->right, value, erased);
+            return erased ? balance(node->value, share(node->left), right) : nullptr;
+        }
+
+        erased = true;
+        if (node->left == nullptr)
+            return share(node->right);
+        if (node->right == nullptr)
+            return share(node->left);
+
+        const Node *minimum = nullptr;
+        const Node *right = eraseMin(node->right, minimum);
+        return balance(minimum->value, share(node->left), right);
+    }
+
+    // Overflow readers count themselves before loading the root, so once no
+    // one is counted after the root was exchanged, no one can still see a
+    // retired root. Flipping the phase before waiting on each half sends new
+    // readers to the other one, so the wait cannot be starved.
+    void drainOverflowReaders()
+    {
+        if (overflowReaders[0].load() == 0 && overflowReaders[1].load() == 0)
             return;
+        for (int round = 0; round < 2; ++round)
+        {
+            const unsigned phase = overflowPhase.load();
+            overflowPhase.store(phase ^ 1);
+            while (overflowReaders[phase].load() != 0)
+                std::this_thread::yield();
         }
+    }
+
+    // Publishes a new root and drops the references of retired roots that no
+    // reader can see any more. Called with writerMutex held.
+    void publish(const Node *newRoot)
+    {
+        const Node *oldRoot = root.exchange(newRoot);
+        retired.push_back({globalEpoch.fetch_add(1), oldRoot});
 
-        Node *successor = pos.findSuccessor(toBeErased);
-        toBeErased->value = successor->value;
-        erase(iterator(successor));
+        if (retired.size() < collectThreshold)
+            return;
 
-        updateHeight(toBeErased);
-        updateBalanceFactor(toBeErased);
+        uint64_t oldestReader = UINT64_MAX;
+        for (const ReaderSlot &slot : slots)
+        {
+            const uint64_t announced = slot.epoch.load();
+            if (announced != idle)
+                oldestReader = std::min(oldestReader, announced);
+        }
+        auto stillVisible = std::partition(retired.begin(), retired.end(),
+                                           [oldestReader](const Retired &entry) { return entry.epoch >= oldestReader; });
+        if (stillVisible != retired.end())
+            drainOverflowReaders();
+        for (auto it = stillVisible; it != retired.end(); ++it)
+            release(it->root);
+        retired.erase(stillVisible, retired.end());
     }
 
-    ~Set()
+public:
+    // Read-only view of the set at the moment snapshot() was called. It holds
+    // a reference to that version's root, so it stays valid and unchanged
+    // while the set keeps being written, and can outlive the set.
+    class Snapshot
     {
-        while (root != nullptr)
+        const Node *root;
+
+        friend class ConcurrentSet;
+
+        explicit Snapshot(const Node *root_) noexcept : root(root_) {}
+
+    public:
+        Snapshot(const Snapshot &other) noexcept : root(share(other.root)) {}
+
+        Snapshot(Snapshot &&other) noexcept : root(other.root)
+        {
+            other.root = nullptr;
+        }
+
+        Snapshot &operator=(Snapshot other) noexcept
+        {
+            std::swap(root, other.root);
+            return *this;
+        }
+
+        ~Snapshot()
         {
-            erase(iterator(root));
+            release(root);
         }
+
+        size_t size() const
+        {
+            return sizeOf(root);
+        }
+
+        bool contains(const T &value) const
+        {
+            return ConcurrentSet::contains(root, value);
+        }
+
+        template <typename Visitor>
+        void for_each(Visitor visitor) const
+        {
+            visit(root, visitor);
+        }
+    };
+
+    ConcurrentSet() = default;
+
+    ConcurrentSet(const ConcurrentSet &) = delete;
+    ConcurrentSet &operator=(const ConcurrentSet &) = delete;
+
+    ~ConcurrentSet()
+    {
+        release(root.load());
+        for (const Retired &entry : retired)
+            release(entry.root);
+    }
+
+    size_t size()
+    {
+        Guard guard(*this);
+        return sizeOf(root.load());
+    }
+
+    bool contains(const T &value)
+    {
+        Guard guard(*this);
+        return contains(root.load(), value);
+    }
+
+    // Calls visitor on every element in order, over the version of the set
+    // that was current when the call started.
+    template <typename Visitor>
+    void for_each(Visitor visitor)
+    {
+        Guard guard(*this);
+        visit(root.load(), visitor);
+    }
+
+    Snapshot snapshot()
+    {
+        Guard guard(*this);
+        return Snapshot(share(root.load()));
+    }
+
+    bool insert(const T &value)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        const Node *updated = insertPath(root.load(), value);
+        if (updated == nullptr)
+            return false;
+        publish(updated);
+        return true;
+    }
+
+    bool erase(const T &value)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        bool erased = false;
+        const Node *updated = erasePath(root.load(), value, erased);
+        if (!erased)
+            return false;
+        publish(updated);
+        return true;
     }
 };
 
+#ifndef SET_NO_MAIN
 int main()
 {
     // First task
@@ -319,3 +2005,4 @@ int main()
 
     return 0;
 }
+#endif
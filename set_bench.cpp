@@ -0,0 +1,679 @@
+// Benchmarks for the sets in set.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread set_bench.cpp -o set_bench
+//   ./set_bench [section] [size]
+//
+// Without arguments every section runs at its default size; a section name
+// runs only that section, optionally at another size.
+
+#define SET_NO_MAIN
+#include "set.cpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+#include <malloc.h>
+
+template <typename Body>
+double secondsFor(Body body)
+{
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps results observable so the timed work is not optimized away.
+static size_t sink = 0;
+
+// Heap bytes malloc currently has handed out in small blocks.
+size_t heapBytesInUse()
+{
+    return mallinfo2().uordblks;
+}
+
+// Resident set size of the process in MiB, after handing freed heap memory
+// back to the system so earlier phases do not hide later allocations.
+double residentMiB()
+{
+    malloc_trim(0);
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+        {
+            return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+// n distinct keys in scattered order: multiplying by an odd constant is a
+// bijection modulo 2^32.
+std::vector<int> scatteredKeys(size_t n)
+{
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = static_cast<int>(static_cast<uint32_t>(i) * 2654435761u);
+    }
+    return keys;
+}
+
+// Set as it was before the slab pool, reduced to what the benchmarks need:
+// every insert is a recursive descent ending in new Node, every erase a
+// delete, and nothing is ever rotated.
+template <typename T>
+class LegacySet
+{
+    struct Node
+    {
+        T value;
+        Node *left;
+        Node *right;
+        Node *parent;
+
+        int height{};
+        int balanceFactor{};
+
+        explicit Node(T value_) noexcept : value(value_), left(nullptr), right(nullptr), parent(nullptr) {}
+    };
+
+    Node *root{};
+    size_t size_{};
+
+    void updateHeight(Node* node) noexcept
+    {
+        int leftHeight = (node->left != nullptr) ? node->left->height : -1;
+        int reightheight = (node->right != nullptr) ? node->right->height : -1;
+        node->height = 1 + std::max(leftHeight, reightheight);
+    }
+
+    int getBalanceFactor(Node* node) noexcept
+    {
+        int leftHeight = (node->left != nullptr) ? node->left->height : -1;
+        int reightheight = (node->right != nullptr) ? node->right->height : -1;
+        return (leftHeight - reightheight);
+    }
+
+    void insert_recursively(Node *&current, const T &value) noexcept
+    {
+        if (!current)
+        {
+            current = new Node(value);
+            ++size_;
+            return;
+        }
+
+        if (value < current->value)
+        {
+            insert_recursively(current->left, value);
+            current->left->parent = current;
+        }
+        else if (value >= current->value && current->value >= value)
+        {
+            return;
+        }
+        else
+        {
+            insert_recursively(current->right, value);
+            current->right->parent = current;
+        }
+
+        updateHeight(current);
+        current->balanceFactor = getBalanceFactor(current);
+    }
+
+    static Node *successorOf(Node *node)
+    {
+        Node *successor = node->right;
+        while (successor->left != nullptr)
+        {
+            successor = successor->left;
+        }
+        return successor;
+    }
+
+    void eraseNode(Node *toBeErased)
+    {
+        if (toBeErased->left != nullptr && toBeErased->right != nullptr)
+        {
+            Node *successor = successorOf(toBeErased);
+            toBeErased->value = successor->value;
+            eraseNode(successor);
+            updateHeight(toBeErased);
+            toBeErased->balanceFactor = getBalanceFactor(toBeErased);
+            return;
+        }
+
+        Node *child = (toBeErased->left != nullptr) ? toBeErased->left : toBeErased->right;
+        if (toBeErased->parent == nullptr)
+        {
+            root = child;
+        }
+        else if (toBeErased->parent->left == toBeErased)
+        {
+            toBeErased->parent->left = child;
+        }
+        else
+        {
+            toBeErased->parent->right = child;
+        }
+        if (child != nullptr)
+        {
+            child->parent = toBeErased->parent;
+        }
+        delete toBeErased;
+        --size_;
+    }
+
+public:
+    LegacySet() = default;
+    LegacySet(const LegacySet &) = delete;
+    LegacySet &operator=(const LegacySet &) = delete;
+
+    void insert(const T &value)
+    {
+        insert_recursively(root, value);
+    }
+
+    Node *find(const T &value)
+    {
+        auto current = root;
+        while (current)
+        {
+            if (value < current->value)
+            {
+                current = current->left;
+            }
+            else if (value >= current->value && current->value >= value)
+            {
+                return current;
+            }
+            else
+            {
+                current = current->right;
+            }
+        }
+        return nullptr;
+    }
+
+    bool erase(const T &value)
+    {
+        Node *node = find(value);
+        if (node == nullptr)
+            return false;
+        eraseNode(node);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    ~LegacySet()
+    {
+        while (root != nullptr)
+        {
+            eraseNode(root);
+        }
+    }
+};
+
+// Uniform access to the three sets for the insert/find/erase benchmark.
+template <typename T>
+bool containsKey(LegacySet<T> &set, const T &key) { return set.find(key) != nullptr; }
+template <typename T>
+bool containsKey(Set<T> &set, const T &key) { return set.find(key) != set.end(); }
+template <typename T>
+bool containsKey(std::set<T> &set, const T &key) { return set.find(key) != set.end(); }
+
+template <typename T>
+void eraseKey(LegacySet<T> &set, const T &key) { set.erase(key); }
+template <typename T>
+void eraseKey(Set<T> &set, const T &key) { set.erase(set.find(key)); }
+template <typename T>
+void eraseKey(std::set<T> &set, const T &key) { set.erase(key); }
+
+// Inserts, finds and erases every key, printing the time per operation and
+// the memory the full set holds.
+template <typename Container>
+void churn(const char *name, const std::vector<int> &keys)
+{
+    const double perKey = 1e9 / static_cast<double>(keys.size());
+    const double before = residentMiB();
+    double memory = 0;
+    double insert = 0;
+    double find = 0;
+    double erase = 0;
+    {
+        Container set;
+        insert = secondsFor([&] {
+            for (int key : keys)
+                set.insert(key);
+        });
+        memory = residentMiB() - before;
+        find = secondsFor([&] {
+            for (int key : keys)
+                sink += containsKey(set, key);
+        });
+        erase = secondsFor([&] {
+            for (int key : keys)
+                eraseKey(set, key);
+        });
+    }
+    std::printf("pool      %-12s insert %6.1f ns, find %6.1f ns, erase %6.1f ns per key, %7.1f MiB\n",
+                name, insert * perKey, find * perKey, erase * perKey, memory);
+}
+
+// Insert, find and erase throughput and memory of the pooled Set against
+// the new/delete version and std::set.
+void benchPool(size_t n)
+{
+    const std::vector<int> keys = scatteredKeys(n);
+    std::printf("pool      %zu scattered keys\n", n);
+    churn<LegacySet<int>>("legacy Set", keys);
+    churn<Set<int>>("Set", keys);
+    churn<std::set<int>>("std::set", keys);
+}
+
+// Builds a Set of n keys inserted in ascending, descending and scattered
+// order and checks the height against the AVL bound of 1.44 log2(n + 2).
+void benchHeight(size_t n)
+{
+    const double bound = 1.4405 * std::log2(static_cast<double>(n) + 2.0) - 0.3277;
+    bool withinBound = true;
+    auto run = [&](const char *order, auto keyAt) {
+        Set<int> set;
+        const double seconds = secondsFor([&] {
+            for (size_t i = 0; i < n; ++i)
+                set.insert(keyAt(i));
+        });
+        const double found = secondsFor([&] {
+            for (size_t i = 0; i < n; ++i)
+                sink += set.find(keyAt(i)) != set.end();
+        });
+        withinBound = withinBound && set.height() + 1 <= bound;
+        std::printf("height    %-10s %zu keys: insert %6.1f ns, find %6.1f ns per key, height %d (bound %.1f)\n",
+                    order, n, seconds * 1e9 / static_cast<double>(n), found * 1e9 / static_cast<double>(n),
+                    set.height(), bound - 1.0);
+    };
+    run("ascending", [](size_t i) { return static_cast<int>(i); });
+    run("descending", [n](size_t i) { return static_cast<int>(n - i); });
+    run("scattered", [](size_t i) { return static_cast<int>(static_cast<uint32_t>(i) * 2654435761u); });
+    if (!withinBound)
+    {
+        std::printf("height    bound exceeded\n");
+        std::exit(1);
+    }
+}
+
+// Average find latency over `lookups` keys drawn pseudo-randomly from the
+// first n scattered keys, so every lookup hits.
+template <typename Container>
+double lookupNs(Container &set, size_t n, size_t lookups)
+{
+    uint64_t state = 88172645463325252ull;
+    const double seconds = secondsFor([&] {
+        for (size_t i = 0; i < lookups; ++i)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const uint32_t index = static_cast<uint32_t>(state % n);
+            sink += set.find(static_cast<int>(index * 2654435761u)) != set.end();
+        }
+    });
+    return seconds * 1e9 / static_cast<double>(lookups);
+}
+
+// Lookup latency of BTreeSet against the AVL Set for sizes from 1M keys up
+// to `largest` in steps of ten. The AVL Set needs about 48 bytes per key,
+// so 100M keys take close to 5 GiB.
+void benchBTree(size_t largest)
+{
+    const size_t lookups = 5000000;
+    for (size_t n = 1000000; n <= largest; n *= 10)
+    {
+        double tree = 0;
+        double avl = 0;
+        {
+            BTreeSet<int> set;
+            for (uint32_t i = 0; i < n; ++i)
+                set.insert(static_cast<int>(i * 2654435761u));
+            tree = lookupNs(set, n, lookups);
+        }
+        {
+            Set<int> set;
+            for (uint32_t i = 0; i < n; ++i)
+                set.insert(static_cast<int>(i * 2654435761u));
+            avl = lookupNs(set, n, lookups);
+        }
+        std::printf("btree     %-10zu keys: BTreeSet %6.1f ns, Set %6.1f ns per find\n", n, tree, avl);
+    }
+}
+
+// Startup cost of loading n sorted keys: one insert per key against
+// assign_sorted and the range constructor.
+void benchBulk(size_t n)
+{
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = static_cast<int>(2 * i);
+
+    const double inserted = secondsFor([&] {
+        Set<int> set;
+        for (int key : keys)
+            set.insert(key);
+        sink += set.size();
+    });
+    const double assigned = secondsFor([&] {
+        Set<int> set;
+        set.assign_sorted(keys.begin(), keys.end());
+        sink += set.size();
+    });
+    const double constructed = secondsFor([&] {
+        Set<int> set(keys.begin(), keys.end());
+        sink += set.size();
+    });
+    std::printf("bulk      %zu sorted keys: insert %.3f s, assign_sorted %.3f s, range constructor %.3f s\n",
+                n, inserted, assigned, constructed);
+}
+
+// rank, select and count_range against answering the same queries by
+// walking the set from begin(), on a set of n keys 0, 2, 4, ...
+void benchOrder(size_t n)
+{
+    Set<int> set;
+    {
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i)
+            keys[i] = static_cast<int>(2 * i);
+        set.assign_sorted(keys.begin(), keys.end());
+    }
+
+    const size_t queries = 1000000;
+    const size_t walks = 20;
+    auto queryKey = [n](size_t q) { return static_cast<int>((q * 2654435761u) % (2 * n)); };
+    auto perQuery = [](double seconds, size_t count) { return seconds * 1e9 / static_cast<double>(count); };
+
+    const double rank = secondsFor([&] {
+        for (size_t q = 0; q < queries; ++q)
+            sink += set.rank(queryKey(q));
+    });
+    const double rankWalk = secondsFor([&] {
+        for (size_t q = 0; q < walks; ++q)
+        {
+            const int key = queryKey(q);
+            size_t count = 0;
+            for (auto it = set.begin(); it != set.end() && *it < key; ++it)
+                ++count;
+            sink += count;
+        }
+    });
+
+    const double select = secondsFor([&] {
+        for (size_t q = 0; q < queries; ++q)
+            sink += *set.select(q * 2654435761u % n);
+    });
+    const double selectWalk = secondsFor([&] {
+        for (size_t q = 0; q < walks; ++q)
+        {
+            auto it = set.begin();
+            for (size_t k = q * 2654435761u % n; k != 0; --k)
+                ++it;
+            sink += *it;
+        }
+    });
+
+    const double range = secondsFor([&] {
+        for (size_t q = 0; q < queries; ++q)
+        {
+            const int lo = queryKey(q);
+            sink += set.count_range(lo, lo + static_cast<int>(n / 2));
+        }
+    });
+    const double rangeWalk = secondsFor([&] {
+        for (size_t q = 0; q < walks; ++q)
+        {
+            const int lo = queryKey(q);
+            const int hi = lo + static_cast<int>(n / 2);
+            size_t count = 0;
+            for (auto it = set.begin(); it != set.end() && !(hi < *it); ++it)
+                count += !(*it < lo);
+            sink += count;
+        }
+    });
+
+    std::printf("order     %zu keys, ns per query (tree vs walk from begin):\n", n);
+    std::printf("order     rank        %8.1f vs %14.1f\n", perQuery(rank, queries), perQuery(rankWalk, walks));
+    std::printf("order     select      %8.1f vs %14.1f\n", perQuery(select, queries), perQuery(selectWalk, walks));
+    std::printf("order     count_range %8.1f vs %14.1f\n", perQuery(range, queries), perQuery(rangeWalk, walks));
+}
+
+// Set of count keys start, start + step, start + 2 * step, ...
+Set<int> arithmeticSet(size_t count, int start, int step)
+{
+    std::vector<int> keys(count);
+    for (size_t i = 0; i < count; ++i)
+        keys[i] = start + static_cast<int>(i) * step;
+    return Set<int>(keys.begin(), keys.end());
+}
+
+// Join-based union, intersection and difference of an n-key set with an
+// m-key set, against intersecting by iterating the smaller set and calling
+// find on the larger. The operands are copied outside the timed region
+// since the operations consume them.
+void benchAlgebraRatio(size_t n, size_t m)
+{
+    const Set<int> large = arithmeticSet(n, 0, 3);
+    const Set<int> small = arithmeticSet(m, 0, static_cast<int>(3 * n / m / 2 * 2 + 1));
+
+    auto timed = [&](void (Set<int>::*op)(Set<int> &)) {
+        Set<int> lhs(large);
+        Set<int> rhs(small);
+        const double seconds = secondsFor([&] { (lhs.*op)(rhs); });
+        sink += lhs.size();
+        return seconds;
+    };
+    const double unite = timed(&Set<int>::unite);
+    const double intersect = timed(&Set<int>::intersect);
+    const double subtract = timed(&Set<int>::subtract);
+
+    Set<int> lhs(large);
+    Set<int> rhs(small);
+    const double probing = secondsFor([&] {
+        Set<int> result;
+        for (int key : rhs)
+            if (lhs.find(key) != lhs.end())
+                result.insert(key);
+        sink += result.size();
+    });
+    std::printf("algebra   %zu x %zu: unite %.4f s, intersect %.4f s, subtract %.4f s, find-based intersect %.4f s\n",
+                n, m, unite, intersect, subtract, probing);
+}
+
+// Balanced and skewed size ratios against an n-key set.
+void benchAlgebra(size_t n)
+{
+    benchAlgebraRatio(n, n);
+    benchAlgebraRatio(n, n / 1000);
+}
+
+// std::set behind a reader-writer lock, the usual alternative to
+// ConcurrentSet.
+class LockedSet
+{
+    std::set<int> set;
+    std::shared_mutex lock;
+
+public:
+    bool contains(int key)
+    {
+        std::shared_lock<std::shared_mutex> reading(lock);
+        return set.count(key) != 0;
+    }
+
+    bool insert(int key)
+    {
+        std::lock_guard<std::shared_mutex> writing(lock);
+        return set.insert(key).second;
+    }
+
+    bool erase(int key)
+    {
+        std::lock_guard<std::shared_mutex> writing(lock);
+        return set.erase(key) != 0;
+    }
+};
+
+// Spreads operations over threads drawing keys from [0, keyRange):
+// readPercent of them are contains(), the rest alternate insert and erase.
+// Returns millions of operations per second.
+template <typename Container>
+double mixedMops(Container &set, int keyRange, size_t threads, size_t operations, unsigned readPercent)
+{
+    const size_t perThread = operations / threads;
+    std::vector<size_t> hits(threads);
+    std::vector<std::thread> workers;
+    const double seconds = secondsFor([&] {
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                std::minstd_rand rng(static_cast<unsigned>(t + 1));
+                for (size_t i = 0; i < perThread; ++i)
+                {
+                    const int key = static_cast<int>(rng() % static_cast<unsigned>(keyRange));
+                    if (rng() % 100 < readPercent)
+                        hits[t] += set.contains(key);
+                    else if (i % 2 == 0)
+                        hits[t] += set.insert(key);
+                    else
+                        hits[t] += set.erase(key);
+                }
+            });
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+    });
+    for (size_t count : hits)
+        sink += count;
+    return static_cast<double>(perThread * threads) / seconds / 1e6;
+}
+
+// Mixed read/write throughput of ConcurrentSet against a locked std::set
+// from 1 to 64 threads, on sets holding about half of 200000 keys.
+void benchConcurrent(size_t operations)
+{
+    const int keyRange = 200000;
+    ConcurrentSet<int> concurrent;
+    LockedSet locked;
+    for (int key = 0; key < keyRange; key += 2)
+    {
+        concurrent.insert(key);
+        locked.insert(key);
+    }
+    std::printf("concurrent %zu operations, %u hardware threads\n", operations, std::thread::hardware_concurrency());
+    for (unsigned readPercent : {99u, 90u, 50u})
+    {
+        for (size_t threads = 1; threads <= 64; threads *= 2)
+        {
+            const double lockFree = mixedMops(concurrent, keyRange, threads, operations, readPercent);
+            const double withLock = mixedMops(locked, keyRange, threads, operations, readPercent);
+            std::printf("concurrent %2u%% reads, %2zu threads: ConcurrentSet %6.2f Mops/s, locked std::set %6.2f Mops/s\n",
+                        readPercent, threads, lockFree, withLock);
+        }
+    }
+}
+
+// Write throughput of a ConcurrentSet of about 100000 keys while 0, 1 or 10
+// snapshots taken at even intervals stay alive, and the memory each of them
+// keeps from being reclaimed, measured as heap released when they are
+// dropped and converted to nodes at the set's own bytes per node.
+void benchSnapshots(size_t writes)
+{
+    const int keyRange = 200000;
+    std::printf("snapshots %zu writes on %d keys\n", writes, keyRange / 2);
+    for (size_t live : {0u, 1u, 10u})
+    {
+        const size_t empty = heapBytesInUse();
+        ConcurrentSet<int> set;
+        for (int key = 0; key < keyRange; key += 2)
+            set.insert(key);
+        const double bytesPerNode = static_cast<double>(heapBytesInUse() - empty) / static_cast<double>(set.size());
+
+        std::vector<ConcurrentSet<int>::Snapshot> snapshots;
+        snapshots.reserve(live);
+        const size_t interval = live != 0 ? writes / live : writes;
+        std::minstd_rand rng(1);
+        const double seconds = secondsFor([&] {
+            for (size_t i = 0; i < writes; ++i)
+            {
+                if (snapshots.size() < live && i % interval == 0)
+                    snapshots.push_back(set.snapshot());
+                const int key = static_cast<int>(rng() % static_cast<unsigned>(keyRange));
+                sink += i % 2 == 0 ? set.insert(key) : set.erase(key);
+            }
+        });
+
+        const size_t withSnapshots = heapBytesInUse();
+        snapshots.clear();
+        const double released = static_cast<double>(withSnapshots - heapBytesInUse());
+        const double perSnapshot = live != 0 ? 1.0 / static_cast<double>(live) : 0.0;
+        std::printf("snapshots %2zu live: %5.2f M writes/s, %7.0f nodes and %5.2f MiB retained per snapshot\n",
+                    live, static_cast<double>(writes) / seconds / 1e6, released / bytesPerNode * perSnapshot,
+                    released * perSnapshot / (1024.0 * 1024.0));
+        sink += set.size();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const std::string only = argc > 1 ? argv[1] : "";
+    const size_t size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    auto wants = [&](const char *name) { return only.empty() || only == name; };
+
+    if (wants("pool"))
+    {
+        benchPool(size != 0 ? size : 10000000);
+    }
+    if (wants("height"))
+    {
+        benchHeight(size != 0 ? size : 10000000);
+    }
+    if (wants("btree"))
+    {
+        benchBTree(size != 0 ? size : 10000000);
+    }
+    if (wants("bulk"))
+    {
+        benchBulk(size != 0 ? size : 20000000);
+    }
+    if (wants("order"))
+    {
+        benchOrder(size != 0 ? size : 10000000);
+    }
+    if (wants("algebra"))
+    {
+        benchAlgebra(size != 0 ? size : 10000000);
+    }
+    if (wants("concurrent"))
+    {
+        benchConcurrent(size != 0 ? size : 2000000);
+    }
+    if (wants("snapshots"))
+    {
+        benchSnapshots(size != 0 ? size : 1000000);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
@@ -1,89 +1,303 @@
 #include <iostream>
+#include <algorithm>
+#include <array>
 #include <climits>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
-template <typename T>
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define PRODUCT_AVX2_DISPATCH 1
+#else
+#define PRODUCT_AVX2_DISPATCH 0
+#endif
+
+// Moves count live elements into uninitialized storage and ends their
+// lifetime at the source. Trivially copyable types are moved bytewise;
+// others are moved if that cannot throw and copied otherwise, so a
+// throwing relocation leaves the source untouched.
+template <typename T, typename Allocator>
+void relocateElements( Allocator& allocator, T* from, std::size_t count, T* to )
+{
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    if constexpr( std::is_trivially_copyable_v<T> ) {
+        if( count != 0 ) {
+            std::memcpy( static_cast<void*>( to ), static_cast<const void*>( from ), count * sizeof( T ) );
+        }
+    } else {
+        std::size_t i = 0;
+        try {
+            for( ; i < count; ++i ) {
+                AllocTraits::construct( allocator, to + i, std::move_if_noexcept( from[i] ) );
+            }
+        } catch( ... ) {
+            for( std::size_t j = 0; j < i; ++j ) {
+                AllocTraits::destroy( allocator, to + j );
+            }
+            throw;
+        }
+        for( std::size_t j = 0; j < count; ++j ) {
+            AllocTraits::destroy( allocator, from + j );
+        }
+    }
+}
+
+template <typename T, typename Allocator = std::allocator<T>>
 class Vector {
 private:
-    T* data;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    T* data{};
     std::size_t capacity{};
     std::size_t size{};
+    Allocator allocator;
 
-public:
-    Vector( ) : capacity{0}, size{0}, data{nullptr} {}
+    T* allocate( std::size_t count )
+    {
+        return count != 0 ? AllocTraits::allocate( allocator, count ) : nullptr;
+    }
+
+    void deallocate( T* storage, std::size_t count ) noexcept
+    {
+        if( storage != nullptr ) {
+            AllocTraits::deallocate( allocator, storage, count );
+        }
+    }
 
-    Vector( std::size_t size_ ) : capacity{ size_ * 2 }, size{ size_ }
+    void destroy( T* first, T* last ) noexcept
     {
-        data = new T[ capacity ];
+        for( ; first != last; ++first ) {
+            AllocTraits::destroy( allocator, first );
+        }
     }
 
-    Vector(const std::initializer_list<T>& listOfElements) : capacity(listOfElements.size() * 2), size(listOfElements.size()) {
-        data = new T[ capacity ];
+    template <typename... Args>
+    void construct( T* where, Args&&... args )
+    {
+        AllocTraits::construct( allocator, where, std::forward<Args>( args )... );
+    }
+
+    // Copies [first, first + count) into uninitialized storage, rolling back on throw.
+    template <typename InputIt>
+    void constructRange( T* where, InputIt first, std::size_t count )
+    {
         std::size_t i = 0;
-        for (const T& element : listOfElements) {
-            data[i++] = element;
+        try {
+            for( ; i < count; ++i, ++first ) {
+                construct( where + i, *first );
+            }
+        } catch( ... ) {
+            destroy( where, where + i );
+            throw;
         }
     }
 
-    Vector( std::size_t size_, const T& init_element ) : capacity( size_ * 2 ), size( size_)
+    void fill( std::size_t count, const T* value )
     {
-        data = new T[ capacity ];
-        for( std::size_t i = 0; i < size; ++i)
-        {
-            data[i] = init_element;
+        std::size_t i = 0;
+        try {
+            for( ; i < count; ++i ) {
+                if( value != nullptr ) {
+                    construct( data + i, *value );
+                } else {
+                    construct( data + i );
+                }
+            }
+        } catch( ... ) {
+            destroy( data, data + i );
+            deallocate( data, capacity );
+            throw;
+        }
+    }
+
+    void relocate( T* from, std::size_t count, T* to )
+    {
+        relocateElements( allocator, from, count, to );
+    }
+
+    void reallocate( std::size_t newCapacity )
+    {
+        T* newData = allocate( newCapacity );
+        try {
+            relocate( data, size, newData );
+        } catch( ... ) {
+            deallocate( newData, newCapacity );
+            throw;
+        }
+        deallocate( data, capacity );
+        data = newData;
+        capacity = newCapacity;
+    }
+
+    std::size_t grownCapacity() const
+    {
+        return capacity != 0 ? capacity * 2 : 1;
+    }
+
+    // The new element is constructed before the old buffer is released, so
+    // arguments referring to elements of this vector stay valid.
+    template <typename... Args>
+    void growAndConstruct( Args&&... args )
+    {
+        const std::size_t newCapacity = grownCapacity();
+        T* newData = allocate( newCapacity );
+        try {
+            construct( newData + size, std::forward<Args>( args )... );
+        } catch( ... ) {
+            deallocate( newData, newCapacity );
+            throw;
+        }
+        try {
+            relocate( data, size, newData );
+        } catch( ... ) {
+            destroy( newData + size, newData + size + 1 );
+            deallocate( newData, newCapacity );
+            throw;
+        }
+        deallocate( data, capacity );
+        data = newData;
+        capacity = newCapacity;
+        ++size;
+    }
+
+    void swapStorage( Vector& other ) noexcept
+    {
+        std::swap( data, other.data );
+        std::swap( capacity, other.capacity );
+        std::swap( size, other.size );
+    }
+
+    void release() noexcept
+    {
+        destroy( data, data + size );
+        deallocate( data, capacity );
+        data = nullptr;
+        size = 0;
+        capacity = 0;
+    }
+
+public:
+    using allocator_type = Allocator;
+
+    Vector( ) noexcept( noexcept( Allocator() ) ) : allocator() {}
+
+    explicit Vector( const Allocator& alloc ) noexcept : allocator( alloc ) {}
+
+    Vector( std::size_t size_, const Allocator& alloc = Allocator() )
+        : capacity{ size_ * 2 }, size{ size_ }, allocator( alloc )
+    {
+        data = allocate( capacity );
+        fill( size, nullptr );
+    }
+
+    Vector(const std::initializer_list<T>& listOfElements, const Allocator& alloc = Allocator())
+        : capacity(listOfElements.size() * 2), size(listOfElements.size()), allocator( alloc ) {
+        data = allocate( capacity );
+        try {
+            constructRange( data, listOfElements.begin(), size );
+        } catch( ... ) {
+            deallocate( data, capacity );
+            throw;
         }
     }
 
-    Vector( const Vector<T>& other )
+    Vector( std::size_t size_, const T& init_element, const Allocator& alloc = Allocator() )
+        : capacity( size_ * 2 ), size( size_), allocator( alloc )
     {
-        capacity = other.capacity;
-        size = other.size;
-        data = new T[capacity];
+        data = allocate( capacity );
+        fill( size, &init_element );
+    }
 
-        for( std::size_t i = 0; i < this->size; ++i ) {
-            data[i] = other.data[i];
+    Vector( const Vector& other )
+        : capacity( other.capacity ), size( other.size ),
+          allocator( AllocTraits::select_on_container_copy_construction( other.allocator ) )
+    {
+        data = allocate( capacity );
+        try {
+            constructRange( data, other.data, size );
+        } catch( ... ) {
+            deallocate( data, capacity );
+            throw;
         }
     }
 
-    Vector( Vector<T>&& other ) noexcept
+    Vector( Vector&& other ) noexcept
+        : data( other.data ), capacity( other.capacity ), size( other.size ),
+          allocator( std::move( other.allocator ) )
     {
-        capacity = other.capacity;
-        size = other.size;
-        data = other.data;
         other.data = nullptr;
         other.size = 0;
         other.capacity = 0;
     }
 
-    Vector<T>& operator=( const Vector<T>& other )
+    Vector& operator=( const Vector& other )
     {
         if( this!= &other ) {
-            capacity = other.capacity;
-            size = other.size;
-            delete [] data;
-            data = new T[capacity];
-
-            for( std::size_t i = 0; i < this->size; ++i ) {
-                data[i] = other.data[i];
+            Vector copy( other, AllocTraits::propagate_on_container_copy_assignment::value
+                                    ? other.allocator : allocator );
+            swapStorage( copy );
+            if constexpr( AllocTraits::propagate_on_container_copy_assignment::value ) {
+                std::swap( allocator, copy.allocator );
             }
         }
 
         return *this;
     }
 
-    Vector<T>& operator=( Vector<T>&& other ) noexcept
+    Vector& operator=( Vector&& other ) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value )
     {
         if( this!= &other ) {
-            capacity = other.capacity;
-            size = other.size;
-            delete [] data;
-            data = other.data;
-            other.data = nullptr;
-            other.size = 0;
-            other.capacity = 0;
+            if constexpr( AllocTraits::propagate_on_container_move_assignment::value ) {
+                release();
+                allocator = std::move( other.allocator );
+                swapStorage( other );
+            } else {
+                if( allocator == other.allocator ) {
+                    release();
+                    swapStorage( other );
+                } else {
+                    Vector moved( allocator );
+                    moved.reserve( other.size );
+                    for( std::size_t i = 0; i < other.size; ++i ) {
+                        moved.construct( moved.data + i, std::move( other.data[i] ) );
+                        ++moved.size;
+                    }
+                    swapStorage( moved );
+                    other.release();
+                }
+            }
         }
         return *this;
     }
 
+    Vector( const Vector& other, const Allocator& alloc )
+        : capacity( other.capacity ), size( other.size ), allocator( alloc )
+    {
+        data = allocate( capacity );
+        try {
+            constructRange( data, other.data, size );
+        } catch( ... ) {
+            deallocate( data, capacity );
+            throw;
+        }
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator;
+    }
+
     std::size_t getCapacity() const
     {
         return capacity;
@@ -94,6 +308,16 @@ public:
         return size;
     }
 
+    const T* getData() const
+    {
+        return data;
+    }
+
+    T* getData()
+    {
+        return data;
+    }
+
     bool empty() const
     {
         if (this->size == 0) return true;
@@ -128,71 +352,820 @@ public:
         return data[index];
     }
 
-    void push_back(const T& element) {
-        if (size == capacity) {
-            capacity *= 2;
-            T* temp = new T[capacity];
-            for (std::size_t i = 0; i < size; ++i) {
-                temp[i] = data[i];
-            }
-            delete[] data;
-            data = temp;
+    void reserve( std::size_t newCapacity )
+    {
+        if( newCapacity > capacity ) {
+            reallocate( newCapacity );
         }
-        data[size++] = element;
     }
 
-    void push_back(const T&& element) {
-        if (size == capacity) {
-            capacity *= 2;
-            T* temp = new T[capacity];
-            for (std::size_t i = 0; i < size; ++i) {
-                temp[i] = data[i];
-            }
-            delete[] data;
-            data = temp;
+    void shrink_to_fit()
+    {
+        if( capacity > size ) {
+            reallocate( size );
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back( Args&&... args )
+    {
+        if( size == capacity ) {
+            growAndConstruct( std::forward<Args>( args )... );
+        } else {
+            construct( data + size, std::forward<Args>( args )... );
+            ++size;
         }
-        data[size++] = std::move(element);
+        return data[size - 1];
+    }
+
+    void push_back(const T& element) {
+        emplace_back( element );
+    }
+
+    void push_back(T&& element) {
+        emplace_back( std::move( element ) );
     }
 
 
     void pop_back() {
         if (size > 0) {
             --size;
+            AllocTraits::destroy( allocator, data + size );
         }
     }
 
     void clear() {
+        destroy( data, data + size );
         size = 0;
     }
 
     ~Vector() {
-        delete[] data;
+        release();
+    }
+
+};
+
+// Vector that keeps up to N elements in inline storage and moves them to the
+// heap only once that is exceeded, so short-lived small vectors never allocate.
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector {
+private:
+    static_assert( N > 0, "SmallVector needs a non-zero inline capacity" );
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    T* data;
+    std::size_t capacity{ N };
+    std::size_t size{};
+    Allocator allocator;
+    alignas( T ) unsigned char inlineStorage[ N * sizeof( T ) ];
+
+    T* inlineData() noexcept
+    {
+        return reinterpret_cast<T*>( inlineStorage );
+    }
+
+    bool isInline() const noexcept
+    {
+        return data == reinterpret_cast<const T*>( inlineStorage );
+    }
+
+    void destroy( T* first, T* last ) noexcept
+    {
+        for( ; first != last; ++first ) {
+            AllocTraits::destroy( allocator, first );
+        }
+    }
+
+    template <typename... Args>
+    void construct( T* where, Args&&... args )
+    {
+        AllocTraits::construct( allocator, where, std::forward<Args>( args )... );
+    }
+
+    void reallocate( std::size_t newCapacity )
+    {
+        T* newData = AllocTraits::allocate( allocator, newCapacity );
+        try {
+            relocateElements( allocator, data, size, newData );
+        } catch( ... ) {
+            AllocTraits::deallocate( allocator, newData, newCapacity );
+            throw;
+        }
+        releaseHeap();
+        data = newData;
+        capacity = newCapacity;
+    }
+
+    void releaseHeap() noexcept
+    {
+        if( !isInline() ) {
+            AllocTraits::deallocate( allocator, data, capacity );
+        }
+    }
+
+    // The new element is constructed before the old buffer is released, so
+    // arguments referring to elements of this vector stay valid.
+    template <typename... Args>
+    void growAndConstruct( Args&&... args )
+    {
+        const std::size_t newCapacity = capacity * 2;
+        T* newData = AllocTraits::allocate( allocator, newCapacity );
+        try {
+            construct( newData + size, std::forward<Args>( args )... );
+        } catch( ... ) {
+            AllocTraits::deallocate( allocator, newData, newCapacity );
+            throw;
+        }
+        try {
+            relocateElements( allocator, data, size, newData );
+        } catch( ... ) {
+            destroy( newData + size, newData + size + 1 );
+            AllocTraits::deallocate( allocator, newData, newCapacity );
+            throw;
+        }
+        releaseHeap();
+        data = newData;
+        capacity = newCapacity;
+        ++size;
+    }
+
+    void copyFrom( const SmallVector& other )
+    {
+        reserve( other.size );
+        for( std::size_t i = 0; i < other.size; ++i ) {
+            construct( data + i, other.data[i] );
+            ++size;
+        }
+    }
+
+    void moveFrom( SmallVector& other )
+    {
+        if( other.isInline() ) {
+            relocateElements( allocator, other.data, other.size, data );
+            size = other.size;
+        } else {
+            data = other.data;
+            capacity = other.capacity;
+            size = other.size;
+            other.data = other.inlineData();
+            other.capacity = N;
+        }
+        other.size = 0;
+    }
+
+public:
+    using allocator_type = Allocator;
+
+    SmallVector( ) : data( inlineData() ), allocator() {}
+
+    explicit SmallVector( const Allocator& alloc ) : data( inlineData() ), allocator( alloc ) {}
+
+    SmallVector( std::size_t size_, const T& init_element, const Allocator& alloc = Allocator() )
+        : SmallVector( alloc )
+    {
+        reserve( size_ );
+        for( ; size < size_; ++size ) {
+            construct( data + size, init_element );
+        }
+    }
+
+    SmallVector( std::initializer_list<T> listOfElements, const Allocator& alloc = Allocator() )
+        : SmallVector( alloc )
+    {
+        reserve( listOfElements.size() );
+        for( const T& element : listOfElements ) {
+            construct( data + size, element );
+            ++size;
+        }
+    }
+
+    SmallVector( const SmallVector& other )
+        : SmallVector( AllocTraits::select_on_container_copy_construction( other.allocator ) )
+    {
+        copyFrom( other );
+    }
+
+    SmallVector( SmallVector&& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+        : data( inlineData() ), allocator( std::move( other.allocator ) )
+    {
+        moveFrom( other );
+    }
+
+    SmallVector& operator=( const SmallVector& other )
+    {
+        if( this != &other ) {
+            clear();
+            copyFrom( other );
+        }
+        return *this;
+    }
+
+    SmallVector& operator=( SmallVector&& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+    {
+        if( this != &other ) {
+            clear();
+            if( !other.isInline() ) {
+                releaseHeap();
+                data = inlineData();
+                capacity = N;
+            }
+            moveFrom( other );
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        releaseHeap();
+    }
+
+    std::size_t getCapacity() const
+    {
+        return capacity;
+    }
+
+    std::size_t getSize() const
+    {
+        return size;
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    const T &operator[](std::size_t index) const
+    {
+        return data[index];
+    }
+
+    T &operator[](std::size_t index)
+    {
+        return data[index];
+    }
+
+    const T& at( std::size_t index ) const
+    {
+        if (index >= size)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index];
+    }
+
+    T& at( std::size_t index )
+    {
+        if (index >= size)
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index];
+    }
+
+    void reserve( std::size_t newCapacity )
+    {
+        if( newCapacity > capacity ) {
+            reallocate( newCapacity );
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back( Args&&... args )
+    {
+        if( size == capacity ) {
+            growAndConstruct( std::forward<Args>( args )... );
+        } else {
+            construct( data + size, std::forward<Args>( args )... );
+            ++size;
+        }
+        return data[size - 1];
+    }
+
+    void push_back( const T& element )
+    {
+        emplace_back( element );
+    }
+
+    void push_back( T&& element )
+    {
+        emplace_back( std::move( element ) );
+    }
+
+    void pop_back()
+    {
+        if( size > 0 ) {
+            --size;
+            AllocTraits::destroy( allocator, data + size );
+        }
+    }
+
+    void clear()
+    {
+        destroy( data, data + size );
+        size = 0;
+    }
+};
+
+// Row-major matrix in one contiguous buffer. Rows are contiguous views,
+// columns are strided views over the same storage.
+template <typename T, typename Allocator = std::allocator<T>>
+class Matrix {
+public:
+    template <typename Element>
+    struct RowView
+    {
+        Element* data;
+        std::size_t size;
+
+        Element& operator[]( std::size_t index ) const { return data[index]; }
+        std::size_t getSize() const { return size; }
+        Element* begin() const { return data; }
+        Element* end() const { return data + size; }
+    };
+
+    template <typename Element>
+    struct ColumnView
+    {
+        Element* data;
+        std::size_t size;
+        std::size_t stride;
+
+        Element& operator[]( std::size_t index ) const { return data[index * stride]; }
+        std::size_t getSize() const { return size; }
+    };
+
+private:
+    Vector<T, Allocator> elements;
+    std::size_t rows{};
+    std::size_t cols{};
+
+    void checkIndex( std::size_t row, std::size_t col ) const
+    {
+        if( row >= rows || col >= cols )
+        {
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+public:
+    Matrix( ) = default;
+
+    Matrix( std::size_t rows_, std::size_t cols_, const T& init_element = T(), const Allocator& alloc = Allocator() )
+        : elements( alloc ), rows( rows_ ), cols( cols_ )
+    {
+        elements.reserve( rows * cols );
+        for( std::size_t i = 0; i < rows * cols; ++i ) {
+            elements.push_back( init_element );
+        }
+    }
+
+    Matrix( std::initializer_list<std::initializer_list<T>> listOfRows, const Allocator& alloc = Allocator() )
+        : elements( alloc ), rows( listOfRows.size() ), cols( rows != 0 ? listOfRows.begin()->size() : 0 )
+    {
+        elements.reserve( rows * cols );
+        for( const auto& row : listOfRows ) {
+            if( row.size() != cols )
+            {
+                throw std::invalid_argument("Matrix rows must have equal length");
+            }
+            for( const T& element : row ) {
+                elements.push_back( element );
+            }
+        }
+    }
+
+    std::size_t getRows() const
+    {
+        return rows;
+    }
+
+    std::size_t getCols() const
+    {
+        return cols;
+    }
+
+    const T* getData() const
+    {
+        return elements.getData();
+    }
+
+    T* getData()
+    {
+        return elements.getData();
+    }
+
+    const T& operator()( std::size_t row, std::size_t col ) const
+    {
+        return elements[row * cols + col];
+    }
+
+    T& operator()( std::size_t row, std::size_t col )
+    {
+        return elements[row * cols + col];
+    }
+
+    const T& at( std::size_t row, std::size_t col ) const
+    {
+        checkIndex( row, col );
+        return elements[row * cols + col];
+    }
+
+    T& at( std::size_t row, std::size_t col )
+    {
+        checkIndex( row, col );
+        return elements[row * cols + col];
+    }
+
+    RowView<const T> row( std::size_t index ) const
+    {
+        return { getData() + index * cols, cols };
+    }
+
+    RowView<T> row( std::size_t index )
+    {
+        return { getData() + index * cols, cols };
+    }
+
+    ColumnView<const T> column( std::size_t index ) const
+    {
+        return { getData() + index, rows, cols };
+    }
+
+    ColumnView<T> column( std::size_t index )
+    {
+        return { getData() + index, rows, cols };
+    }
+};
+
+// Product-except-self kernel over raw storage. Element i belongs to lane
+// i % productLanes and each pass keeps one running product per lane, so the
+// multiplications of a pass form productLanes independent chains instead of
+// one serial chain. The result for i is the product of its own lane's other
+// elements times the totals of all other lanes; those carries seed the
+// backward pass. The generic passes are plain scalar loops; for int
+// products the WrappingMultiply overloads below run the same lane layout
+// with AVX2 where the CPU supports it.
+constexpr std::size_t productLanes = 16;
+
+template <typename Value>
+using LaneProducts = std::array<Value, productLanes>;
+
+// Writes each lane's exclusive prefix products to out and returns the lane
+// totals.
+template <typename Input, typename Value, typename Multiply>
+LaneProducts<Value> productPrefixPass( const Input* nums, Value* out, std::size_t n,
+                                       Value one, Multiply multiply )
+{
+    LaneProducts<Value> acc;
+    acc.fill( one );
+    std::size_t i = 0;
+    for( ; i + productLanes <= n; i += productLanes ) {
+        for( std::size_t s = 0; s < productLanes; ++s ) {
+            out[i + s] = acc[s];
+            acc[s] = multiply( acc[s], nums[i + s] );
+        }
+    }
+    for( std::size_t s = 0; i < n; ++i, ++s ) {
+        out[i] = acc[s];
+        acc[s] = multiply( acc[s], nums[i] );
+    }
+    return acc;
+}
+
+// Seed of each lane for the backward pass: seed times the totals of every
+// other lane.
+template <typename Value, typename Combine>
+LaneProducts<Value> productSuffixSeeds( Value seed, const LaneProducts<Value>& totals, Combine combine )
+{
+    LaneProducts<Value> seeds;
+    for( std::size_t s = 0; s < productLanes; ++s ) {
+        seeds[s] = seed;
+        for( std::size_t t = 0; t < productLanes; ++t ) {
+            if( t != s ) {
+                seeds[s] = combine( seeds[s], totals[t] );
+            }
+        }
+    }
+    return seeds;
+}
+
+// Multiplies the prefixes in out by the suffix products so the result is
+// finished in place.
+template <typename Input, typename Value, typename Multiply, typename Combine>
+void productSuffixPass( const Input* nums, Value* out, std::size_t n, Value seed,
+                        const LaneProducts<Value>& totals, Multiply multiply, Combine combine )
+{
+    LaneProducts<Value> acc = productSuffixSeeds( seed, totals, combine );
+    const std::size_t tailBegin = n - n % productLanes;
+    for( std::size_t i = n; i-- > tailBegin; ) {
+        const std::size_t s = i - tailBegin;
+        out[i] = combine( out[i], acc[s] );
+        acc[s] = multiply( acc[s], nums[i] );
+    }
+    for( std::size_t i = tailBegin; i != 0; ) {
+        i -= productLanes;
+        for( std::size_t s = 0; s < productLanes; ++s ) {
+            out[i + s] = combine( out[i + s], acc[s] );
+            acc[s] = multiply( acc[s], nums[i + s] );
+        }
+    }
+}
+
+template <typename Input, typename Value, typename Multiply, typename Combine>
+void productExceptSelf( const Input* nums, Value* out, std::size_t n, Value one,
+                        Multiply multiply, Combine combine )
+{
+    const auto totals = productPrefixPass( nums, out, n, one, multiply );
+    productSuffixPass( nums, out, n, one, totals, multiply, combine );
+}
+
+// Multiplication modulo 2^32, the int arithmetic productNumsElements
+// reproduces. Passes over it are chosen at run time: the AVX2 kernels where
+// the CPU has AVX2, the generic passes above otherwise.
+struct WrappingMultiply
+{
+    unsigned int operator()( unsigned int lhs, unsigned int rhs ) const
+    {
+        return lhs * rhs;
+    }
+};
+
+#if PRODUCT_AVX2_DISPATCH
+// The 16 lanes live in two registers of eight, so two multiplications are in
+// flight per row.
+__attribute__(( target( "avx2" ) ))
+LaneProducts<unsigned int> wrappingPrefixPassAvx2( const unsigned int* nums, unsigned int* out,
+                                                   std::size_t n, unsigned int one )
+{
+    __m256i low = _mm256_set1_epi32( static_cast<int>( one ) );
+    __m256i high = low;
+    std::size_t i = 0;
+    for( ; i + productLanes <= n; i += productLanes ) {
+        const __m256i numsLow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( nums + i ) );
+        const __m256i numsHigh = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( nums + i + 8 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i ), low );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i + 8 ), high );
+        low = _mm256_mullo_epi32( low, numsLow );
+        high = _mm256_mullo_epi32( high, numsHigh );
+    }
+
+    LaneProducts<unsigned int> acc;
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( acc.data() ), low );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( acc.data() + 8 ), high );
+    for( std::size_t s = 0; i < n; ++i, ++s ) {
+        out[i] = acc[s];
+        acc[s] *= nums[i];
+    }
+    return acc;
+}
+
+__attribute__(( target( "avx2" ) ))
+void wrappingSuffixPassAvx2( const unsigned int* nums, unsigned int* out, std::size_t n,
+                             unsigned int seed, const LaneProducts<unsigned int>& totals )
+{
+    LaneProducts<unsigned int> acc = productSuffixSeeds( seed, totals, WrappingMultiply() );
+    const std::size_t tailBegin = n - n % productLanes;
+    for( std::size_t i = n; i-- > tailBegin; ) {
+        const std::size_t s = i - tailBegin;
+        out[i] *= acc[s];
+        acc[s] *= nums[i];
+    }
+
+    __m256i low = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( acc.data() ) );
+    __m256i high = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( acc.data() + 8 ) );
+    for( std::size_t i = tailBegin; i != 0; ) {
+        i -= productLanes;
+        const __m256i numsLow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( nums + i ) );
+        const __m256i numsHigh = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( nums + i + 8 ) );
+        const __m256i outLow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( out + i ) );
+        const __m256i outHigh = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( out + i + 8 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i ), _mm256_mullo_epi32( outLow, low ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i + 8 ), _mm256_mullo_epi32( outHigh, high ) );
+        low = _mm256_mullo_epi32( low, numsLow );
+        high = _mm256_mullo_epi32( high, numsHigh );
+    }
+}
+
+inline bool cpuHasAvx2()
+{
+    static const bool supported = __builtin_cpu_supports( "avx2" );
+    return supported;
+}
+#endif
+
+inline LaneProducts<unsigned int> productPrefixPass( const unsigned int* nums, unsigned int* out, std::size_t n,
+                                                     unsigned int one, WrappingMultiply multiply )
+{
+#if PRODUCT_AVX2_DISPATCH
+    if( cpuHasAvx2() ) {
+        return wrappingPrefixPassAvx2( nums, out, n, one );
+    }
+#endif
+    return productPrefixPass<unsigned int, unsigned int, WrappingMultiply>( nums, out, n, one, multiply );
+}
+
+inline void productSuffixPass( const unsigned int* nums, unsigned int* out, std::size_t n, unsigned int seed,
+                               const LaneProducts<unsigned int>& totals, WrappingMultiply multiply,
+                               WrappingMultiply combine )
+{
+#if PRODUCT_AVX2_DISPATCH
+    if( cpuHasAvx2() ) {
+        wrappingSuffixPassAvx2( nums, out, n, seed, totals );
+        return;
+    }
+#endif
+    productSuffixPass<unsigned int, unsigned int, WrappingMultiply, WrappingMultiply>(
+        nums, out, n, seed, totals, multiply, combine );
+}
+
+// Runs task(0) ... task(count - 1) on their own threads and waits for all of
+// them. The parallel algorithms accept any executor with this call shape, so
+// they can be handed an existing thread pool instead.
+struct ThreadExecutor
+{
+    template <typename Task>
+    void operator()( std::size_t count, Task task ) const
+    {
+        Vector<std::thread> threads;
+        threads.reserve( count );
+        try {
+            for( std::size_t i = 0; i < count; ++i ) {
+                threads.emplace_back( task, i );
+            }
+        } catch( ... ) {
+            // A joinable std::thread terminates the process when destroyed,
+            // so the tasks already started are waited for before rethrowing.
+            for( std::size_t i = 0; i < threads.getSize(); ++i ) {
+                threads[i].join();
+            }
+            throw;
+        }
+        for( std::size_t i = 0; i < count; ++i ) {
+            threads[i].join();
+        }
     }
 };
 
+// Blocked product-except-self: every block scans its own prefixes in
+// parallel, the block totals are combined serially, then every block runs
+// its suffix pass seeded with the product of all other blocks.
+template <typename Input, typename Value, typename Multiply, typename Combine, typename Executor>
+void productExceptSelfParallel( const Input* nums, Value* out, std::size_t n, Value one,
+                                Multiply multiply, Combine combine,
+                                std::size_t blockCount, Executor& executor )
+{
+    constexpr std::size_t minimumBlockSize = 1 << 16;
+    blockCount = std::max<std::size_t>( 1, std::min( blockCount, n / minimumBlockSize ) );
+    if( blockCount == 1 ) {
+        productExceptSelf( nums, out, n, one, multiply, combine );
+        return;
+    }
+
+    const std::size_t blockSize = n / blockCount;
+    auto blockBegin = [&]( std::size_t block ) { return block * blockSize; };
+    auto blockEnd = [&]( std::size_t block ) { return block + 1 == blockCount ? n : ( block + 1 ) * blockSize; };
+
+    Vector<LaneProducts<Value>> laneTotals( blockCount );
+    executor( blockCount, [&]( std::size_t block ) {
+        const std::size_t begin = blockBegin( block );
+        laneTotals[block] = productPrefixPass( nums + begin, out + begin, blockEnd( block ) - begin, one, multiply );
+    } );
+
+    Vector<Value> blockTotals( blockCount, one );
+    for( std::size_t block = 0; block < blockCount; ++block ) {
+        for( const Value& total : laneTotals[block] ) {
+            blockTotals[block] = combine( blockTotals[block], total );
+        }
+    }
+
+    executor( blockCount, [&]( std::size_t block ) {
+        Value seed = one;
+        for( std::size_t other = 0; other < blockCount; ++other ) {
+            if( other != block ) {
+                seed = combine( seed, blockTotals[other] );
+            }
+        }
+        const std::size_t begin = blockBegin( block );
+        productSuffixPass( nums + begin, out + begin, blockEnd( block ) - begin, seed,
+                           laneTotals[block], multiply, combine );
+    } );
+}
+
+// Products wrap modulo 2^32 like the int arithmetic they replace; the scan
+// runs on unsigned values so the wraparound is well defined.
 auto productNumsElements( const Vector< int >& nums )
 {
     const std::size_t n = nums.getSize();
-    Vector< int > result(n, 1);
+    Vector< int > result(n);
+
+    productExceptSelf( reinterpret_cast<const unsigned int*>( nums.getData() ),
+                       reinterpret_cast<unsigned int*>( result.getData() ),
+                       n, 1u, WrappingMultiply(), WrappingMultiply() );
+
+    return result;
+}
+
+// Same results as productNumsElements, computed in blockCount blocks on the
+// given executor. The executor is taken by reference, so a caller's thread
+// pool is used in place rather than copied.
+template <typename Executor = ThreadExecutor>
+auto productNumsElementsParallel( const Vector< int >& nums,
+                                  std::size_t blockCount = std::thread::hardware_concurrency(),
+                                  Executor&& executor = Executor() )
+{
+    const std::size_t n = nums.getSize();
+    Vector< int > result(n);
+
+    productExceptSelfParallel( reinterpret_cast<const unsigned int*>( nums.getData() ),
+                               reinterpret_cast<unsigned int*>( result.getData() ),
+                               n, 1u, WrappingMultiply(), WrappingMultiply(), blockCount, executor );
+
+    return result;
+}
+
+// Every product is reduced modulo modulus, so the results are exact residues
+// no matter how large the true products get.
+auto productNumsElementsModulo( const Vector< int >& nums, int modulus )
+{
+    if( modulus <= 0 )
+    {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+
+    const std::size_t n = nums.getSize();
+    Vector< int > result(n);
+
+    const auto m = static_cast<std::uint64_t>( modulus );
+    auto combine = [m]( int lhs, int rhs ) {
+        return static_cast<int>( static_cast<std::uint64_t>( lhs ) * static_cast<std::uint64_t>( rhs ) % m );
+    };
+    auto multiply = [m, combine]( int acc, int value ) {
+        long long residue = value % static_cast<long long>( m );
+        if( residue < 0 ) {
+            residue += static_cast<long long>( m );
+        }
+        return combine( acc, static_cast<int>( residue ) );
+    };
+    productExceptSelf( nums.getData(), result.getData(), n, static_cast<int>( 1 % m ), multiply, combine );
+
+    return result;
+}
+
+struct ProductOverflow : std::overflow_error
+{
+    std::size_t index;
+
+    explicit ProductOverflow( std::size_t index_ )
+        : std::overflow_error( "Product does not fit in int at index " + std::to_string( index_ ) ), index( index_ ) {}
+};
+
+// Computes exact products and throws ProductOverflow for the first index whose
+// product does not fit in an int. Partial products are saturated just past
+// the int range, which keeps every intermediate product within long long.
+auto productNumsElementsChecked( const Vector< int >& nums )
+{
+    auto multiply = []( long long lhs, long long rhs ) {
+        constexpr long long saturated = static_cast<long long>( INT_MAX ) + 2;
+        const long long product = lhs * rhs;
+        return std::max( -saturated, std::min( saturated, product ) );
+    };
 
-    std::size_t leftProduct = 1;
-    std::size_t rightProduct = 1;
+    const std::size_t n = nums.getSize();
+    Vector< long long > leftProducts;
+    leftProducts.reserve( n );
 
+    long long leftProduct = 1;
     for( std::size_t i = 0; i < n; ++i )
     {
-        result.at(i) *= leftProduct;
-        leftProduct *= nums.at(i);
+        leftProducts.push_back( leftProduct );
+        leftProduct = multiply( leftProduct, nums[i] );
+    }
+
+    Vector< int > result(n);
+    std::size_t overflowIndex = n;
+    long long rightProduct = 1;
+    for( std::size_t i = n; i-- > 0; )
+    {
+        const long long product = leftProducts[i] * rightProduct;
+        if( product < INT_MIN || product > INT_MAX ) {
+            overflowIndex = i;
+        } else {
+            result[i] = static_cast<int>( product );
+        }
+        rightProduct = multiply( rightProduct, nums[i] );
     }
 
-    for (int i = n - 1; i >= 0; i--) {
-        result[i] *= rightProduct;
-        rightProduct *= nums[i];
+    if( overflowIndex != n )
+    {
+        throw ProductOverflow( overflowIndex );
     }
 
     return result;
 }
 
-auto findLuckyNumbers( const Vector<Vector< int >> matrix )
+auto findLuckyNumbers( const Vector<Vector< int >>& matrix )
 {
     Vector<int> result;
 
@@ -203,16 +1176,191 @@ auto findLuckyNumbers( const Vector<Vector< int >> matrix )
     Vector<int> colMaximumElements(m, INT_MIN);
 
     for (std::size_t i = 0; i < n; ++i) {
+        const Vector<int>& row = matrix[i];
+        if (row.getSize() < m) {
+            throw std::out_of_range("Index out of range");
+        }
+        for (std::size_t j = 0; j < m; ++j) {
+            rowMinimumElements[i] = std::min(rowMinimumElements[i], row[j]);
+            colMaximumElements[j] = std::max(colMaximumElements[j], row[j]);
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const Vector<int>& row = matrix[i];
         for (std::size_t j = 0; j < m; ++j) {
-            rowMinimumElements[i] = std::min(rowMinimumElements[i], matrix.at(i).at(j));
-            colMaximumElements[j] = std::max(colMaximumElements[j], matrix.at(i).at(j));
+            if (rowMinimumElements[i] == row[j] && colMaximumElements[j] == row[j]) {
+                result.push_back(row[j]);
+            }
         }
     }
 
+    return result;
+}
+
+// Folds one row into the running column maxima and returns the row minimum.
+inline int scanLuckyRow( const int* row, std::size_t m, int* colMaximum )
+{
+    int rowMinimum = INT_MAX;
+    for (std::size_t j = 0; j < m; ++j) {
+        rowMinimum = std::min(rowMinimum, row[j]);
+        colMaximum[j] = std::max(colMaximum[j], row[j]);
+    }
+    return rowMinimum;
+}
+
+inline int largestOf( const Vector<int>& values )
+{
+    int largest = INT_MIN;
+    for (std::size_t i = 0; i < values.getSize(); ++i) {
+        largest = std::max(largest, values[i]);
+    }
+    return largest;
+}
+
+inline int smallestOf( const Vector<int>& values )
+{
+    int smallest = INT_MAX;
+    for (std::size_t i = 0; i < values.getSize(); ++i) {
+        smallest = std::min(smallest, values[i]);
+    }
+    return smallest;
+}
+
+// Row minima and column maxima are gathered in one fused pass over the
+// contiguous rows. Every lucky number equals both the largest row minimum
+// and the smallest column maximum, so only rows whose minimum is that value
+// are scanned again.
+auto findLuckyNumbers( const Matrix< int >& matrix )
+{
+    Vector<int> result;
+
+    const std::size_t n = matrix.getRows();
+    const std::size_t m = matrix.getCols();
+
+    Vector<int> rowMinimumElements(n);
+    Vector<int> colMaximumElements(m, INT_MIN);
+    int* colMaximum = colMaximumElements.getData();
+
     for (std::size_t i = 0; i < n; ++i) {
+        rowMinimumElements[i] = scanLuckyRow(matrix.row(i).data, m, colMaximum);
+    }
+
+    const int largestRowMinimum = largestOf(rowMinimumElements);
+    if (n == 0 || m == 0 || largestRowMinimum != smallestOf(colMaximumElements)) {
+        return result;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (rowMinimumElements[i] != largestRowMinimum) {
+            continue;
+        }
+        const int* row = matrix.row(i).data;
         for (std::size_t j = 0; j < m; ++j) {
-            if (rowMinimumElements[i] == matrix.at(i).at(j) && colMaximumElements[j] == matrix.at(i).at(j)) {
-                result.push_back(matrix.at(i).at(j));
+            if (row[j] == largestRowMinimum && colMaximum[j] == largestRowMinimum) {
+                result.push_back(row[j]);
+            }
+        }
+    }
+
+    return result;
+}
+
+// Out-of-core variant of findLuckyNumbers over a file of rows * cols native
+// ints stored row-major. Bands of rows are streamed in chunks of about
+// chunkBytes on the executor, each band keeping its own column maxima that
+// are merged afterwards; only the row minima (one int per row) stay
+// resident. The second pass reads back just the rows whose minimum can be
+// lucky. Like productNumsElementsParallel, the executor is used in place.
+template <typename Executor = ThreadExecutor>
+auto findLuckyNumbersInFile( const std::string& path, std::size_t rows, std::size_t cols,
+                             std::size_t bandCount = std::thread::hardware_concurrency(),
+                             std::size_t chunkBytes = std::size_t{ 1 } << 22,
+                             Executor&& executor = Executor() )
+{
+    Vector<int> result;
+    if (rows == 0 || cols == 0) {
+        return result;
+    }
+
+    const std::size_t rowBytes = cols * sizeof(int);
+    const std::size_t rowsPerChunk = std::max<std::size_t>(1, chunkBytes / rowBytes);
+    bandCount = std::max<std::size_t>(1, std::min(bandCount, rows));
+    const std::size_t bandSize = rows / bandCount;
+
+    auto openAt = [&]( std::ifstream& file, std::size_t row ) {
+        file.open(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        file.seekg(static_cast<std::streamoff>(row * rowBytes));
+    };
+    auto readRows = [&]( std::ifstream& file, int* buffer, std::size_t count ) {
+        file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(count * rowBytes));
+        if (static_cast<std::size_t>(file.gcount()) != count * rowBytes) {
+            throw std::runtime_error("Unexpected end of " + path);
+        }
+    };
+
+    Vector<int> rowMinimumElements(rows);
+    Vector<Vector<int>> bandMaximumElements(bandCount);
+    Vector<std::exception_ptr> errors(bandCount);
+
+    executor( bandCount, [&]( std::size_t band ) {
+        try {
+            const std::size_t begin = band * bandSize;
+            const std::size_t end = band + 1 == bandCount ? rows : begin + bandSize;
+
+            Vector<int> colMaximumElements(cols, INT_MIN);
+            // Sized to one chunk exactly; Vector(size_t) reserves twice its size.
+            std::unique_ptr<int[]> chunk(new int[std::min(rowsPerChunk, end - begin) * cols]);
+
+            std::ifstream file;
+            openAt(file, begin);
+            for (std::size_t row = begin; row < end; row += rowsPerChunk) {
+                const std::size_t count = std::min(rowsPerChunk, end - row);
+                readRows(file, chunk.get(), count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    rowMinimumElements[row + i] = scanLuckyRow(chunk.get() + i * cols, cols,
+                                                               colMaximumElements.getData());
+                }
+            }
+            bandMaximumElements[band] = std::move(colMaximumElements);
+        } catch (...) {
+            errors[band] = std::current_exception();
+        }
+    } );
+
+    for (std::size_t band = 0; band < bandCount; ++band) {
+        if (errors[band]) {
+            std::rethrow_exception(errors[band]);
+        }
+    }
+
+    Vector<int>& colMaximumElements = bandMaximumElements[0];
+    for (std::size_t band = 1; band < bandCount; ++band) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            colMaximumElements[j] = std::max(colMaximumElements[j], bandMaximumElements[band][j]);
+        }
+    }
+
+    const int largestRowMinimum = largestOf(rowMinimumElements);
+    if (largestRowMinimum != smallestOf(colMaximumElements)) {
+        return result;
+    }
+
+    Vector<int> row(cols);
+    std::ifstream file;
+    openAt(file, 0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (rowMinimumElements[i] != largestRowMinimum) {
+            continue;
+        }
+        file.seekg(static_cast<std::streamoff>(i * rowBytes));
+        readRows(file, row.getData(), 1);
+        for (std::size_t j = 0; j < cols; ++j) {
+            if (row[j] == largestRowMinimum && colMaximumElements[j] == largestRowMinimum) {
+                result.push_back(row[j]);
             }
         }
     }
@@ -220,6 +1368,7 @@ auto findLuckyNumbers( const Vector<Vector< int >> matrix )
     return result;
 }
 
+#ifndef VECTOR_NO_MAIN
 int main()
 {
     //First task
@@ -254,3 +1403,4 @@ int main()
 
     return 0;
 }
+#endif
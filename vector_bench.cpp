@@ -0,0 +1,330 @@
+// Benchmarks for the containers and algorithms in vector.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread vector_bench.cpp -o vector_bench
+//   ./vector_bench [section] [size]
+//
+// Without arguments every section runs at its default size; a section name
+// runs only that section, optionally at another size.
+
+#define VECTOR_NO_MAIN
+#include "vector.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+template <typename Body>
+double secondsFor( Body body )
+{
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// Keeps results observable so the timed work is not optimized away.
+static std::size_t sink = 0;
+
+// Vector as it was before the allocator rework, reduced to what the growth
+// benchmark needs: storage comes from new T[capacity] and every regrowth
+// copy-assigns into freshly default-constructed slots.
+template <typename T>
+class LegacyVector {
+private:
+    T* data;
+    std::size_t capacity{};
+    std::size_t size{};
+
+public:
+    // The legacy default constructor left capacity at 0, and push_back then
+    // wrote past a zero-length array, so growth starts from one element.
+    LegacyVector( std::size_t size_ ) : capacity{ size_ * 2 }, size{ size_ }
+    {
+        data = new T[ capacity ];
+    }
+
+    LegacyVector( const LegacyVector& ) = delete;
+    LegacyVector& operator=( const LegacyVector& ) = delete;
+
+    std::size_t getSize() const
+    {
+        return size;
+    }
+
+    void push_back(const T& element) {
+        if (size == capacity) {
+            capacity *= 2;
+            T* temp = new T[capacity];
+            for (std::size_t i = 0; i < size; ++i) {
+                temp[i] = data[i];
+            }
+            delete[] data;
+            data = temp;
+        }
+        data[size++] = element;
+    }
+
+    ~LegacyVector() {
+        delete[] data;
+    }
+};
+
+// Growth of Vector<std::string> by push_back, and the cost of
+// reserving room for many heavy elements that are never used.
+void benchGrowth( std::size_t n )
+{
+    const std::string value( 40, 'x' );
+
+    const double legacy = secondsFor( [&] {
+        LegacyVector<std::string> strings( 1 );
+        for( std::size_t i = 1; i < n; ++i ) {
+            strings.push_back( value );
+        }
+        sink += strings.getSize();
+    } );
+    const double current = secondsFor( [&] {
+        Vector<std::string> strings;
+        for( std::size_t i = 0; i < n; ++i ) {
+            strings.push_back( value );
+        }
+        sink += strings.getSize();
+    } );
+    const double standard = secondsFor( [&] {
+        std::vector<std::string> strings;
+        for( std::size_t i = 0; i < n; ++i ) {
+            strings.push_back( value );
+        }
+        sink += strings.size();
+    } );
+    std::printf( "growth    push_back %zu strings: legacy %.3f s, Vector %.3f s, std::vector %.3f s\n",
+                 n, legacy, current, standard );
+
+    const std::size_t slots = 10 * n;
+    const double legacyReserve = secondsFor( [&] {
+        LegacyVector<std::string> strings( slots / 2 );
+        sink += strings.getSize();
+    } );
+    const double currentReserve = secondsFor( [&] {
+        Vector<std::string> strings;
+        strings.reserve( slots );
+        sink += strings.getCapacity();
+    } );
+    std::printf( "growth    room for %zu strings: legacy %.3f s, Vector::reserve %.6f s\n",
+                 slots, legacyReserve, currentReserve );
+}
+
+// Allocator that counts the allocations made through it.
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    static inline std::size_t allocations = 0;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator( const CountingAllocator<U>& ) noexcept {}
+
+    T* allocate( std::size_t count )
+    {
+        ++allocations;
+        return std::allocator<T>().allocate( count );
+    }
+
+    void deallocate( T* pointer, std::size_t count ) noexcept
+    {
+        std::allocator<T>().deallocate( pointer, count );
+    }
+
+    friend bool operator==( const CountingAllocator&, const CountingAllocator& ) { return true; }
+    friend bool operator!=( const CountingAllocator&, const CountingAllocator& ) { return false; }
+};
+
+// Builds, reads and drops `rounds` short vectors of 1 to 16 ints and prints
+// the time and the allocations per vector.
+template <typename Container>
+void shortLived( const char* name, std::size_t rounds )
+{
+    CountingAllocator<int>::allocations = 0;
+    const double seconds = secondsFor( [&] {
+        for( std::size_t round = 0; round < rounds; ++round ) {
+            Container values;
+            const std::size_t length = 1 + round % 16;
+            for( std::size_t i = 0; i < length; ++i ) {
+                values.push_back( static_cast<int>( i ) );
+            }
+            sink += static_cast<std::size_t>( values[length - 1] );
+        }
+    } );
+    std::printf( "small     %-28s %.1f ns per vector, %.2f allocations per vector\n", name,
+                 seconds * 1e9 / static_cast<double>( rounds ),
+                 static_cast<double>( CountingAllocator<int>::allocations ) / static_cast<double>( rounds ) );
+}
+
+// Allocation count and latency of short-lived vectors.
+void benchSmall( std::size_t rounds )
+{
+    shortLived<Vector<int, CountingAllocator<int>>>( "Vector<int>", rounds );
+    shortLived<SmallVector<int, 16, CountingAllocator<int>>>( "SmallVector<int, 16>", rounds );
+    shortLived<std::vector<int, CountingAllocator<int>>>( "std::vector<int>", rounds );
+}
+
+// Product-except-self as it was before the lane kernel: one running product
+// forward into the result, one backward.
+void legacyProducts( const unsigned int* nums, unsigned int* out, std::size_t n )
+{
+    unsigned int prefix = 1;
+    for( std::size_t i = 0; i < n; ++i ) {
+        out[i] = prefix;
+        prefix *= nums[i];
+    }
+    unsigned int suffix = 1;
+    for( std::size_t i = n; i-- > 0; ) {
+        out[i] *= suffix;
+        suffix *= nums[i];
+    }
+}
+
+// The scalar loop against the generic lane kernel and the pass overloads
+// for WrappingMultiply, which pick the AVX2 kernel where the CPU has it, for
+// sizes from 1K up to `largest`.
+void benchProduct( std::size_t largest )
+{
+    for( std::size_t n = 1000; n <= largest; n *= 10 ) {
+        std::vector<unsigned int> nums( n );
+        for( std::size_t i = 0; i < n; ++i ) {
+            nums[i] = static_cast<unsigned int>( i * 2654435761u ) | 1u;
+        }
+        std::vector<unsigned int> out( n );
+
+        const std::size_t repeats = std::max<std::size_t>( 1, 100000000 / n );
+        const double legacy = secondsFor( [&] {
+            for( std::size_t r = 0; r < repeats; ++r ) {
+                legacyProducts( nums.data(), out.data(), n );
+                sink += out[r % n];
+            }
+        } );
+        const double lanes = secondsFor( [&] {
+            for( std::size_t r = 0; r < repeats; ++r ) {
+                const auto totals = productPrefixPass<unsigned int, unsigned int, WrappingMultiply>(
+                    nums.data(), out.data(), n, 1u, WrappingMultiply() );
+                productSuffixPass<unsigned int, unsigned int, WrappingMultiply, WrappingMultiply>(
+                    nums.data(), out.data(), n, 1u, totals, WrappingMultiply(), WrappingMultiply() );
+                sink += out[r % n];
+            }
+        } );
+        const double dispatched = secondsFor( [&] {
+            for( std::size_t r = 0; r < repeats; ++r ) {
+                productExceptSelf( nums.data(), out.data(), n, 1u, WrappingMultiply(), WrappingMultiply() );
+                sink += out[r % n];
+            }
+        } );
+        const double scale = 1e9 / static_cast<double>( repeats * n );
+        std::printf( "product   n=%-10zu scalar %.3f ns, lanes %.3f ns, dispatched %.3f ns per element\n",
+                     n, legacy * scale, lanes * scale, dispatched * scale );
+    }
+}
+
+// findLuckyNumbers as it was before Matrix: the matrix is taken by value
+// and every access goes through two bounds-checked at() calls.
+auto legacyLuckyNumbers( const Vector<Vector<int>> matrix )
+{
+    Vector<int> result;
+
+    std::size_t n = matrix.getSize();
+    std::size_t m = matrix.at(0).getSize();
+
+    Vector<int> rowMinimumElements(n, INT_MAX);
+    Vector<int> colMaximumElements(m, INT_MIN);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            rowMinimumElements[i] = std::min(rowMinimumElements[i], matrix.at(i).at(j));
+            colMaximumElements[j] = std::max(colMaximumElements[j], matrix.at(i).at(j));
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            if (rowMinimumElements[i] == matrix.at(i).at(j) && colMaximumElements[j] == matrix.at(i).at(j)) {
+                result.push_back(matrix.at(i).at(j));
+            }
+        }
+    }
+
+    return result;
+}
+
+// Element (i, j) of the benchmark matrices, with one lucky number planted
+// on the diagonal so every variant has something to find.
+int luckyElement( std::size_t i, std::size_t j, std::size_t n )
+{
+    if( i == n / 2 ) {
+        return i == j ? 1 << 30 : ( 1 << 30 ) + 1 + static_cast<int>( j % 1000 );
+    }
+    if( j == n / 2 ) {
+        return static_cast<int>( ( i * 7919 ) % 100000 );
+    }
+    return static_cast<int>( ( i * 2654435761u + j * 40503u ) % 1000000000u );
+}
+
+// The legacy and nested-Vector findLuckyNumbers against the Matrix overload
+// on an n x n matrix. The nested matrix is released before the Matrix is
+// built, so the peak is two copies of the data (the legacy by-value copy).
+void benchLucky( std::size_t n )
+{
+    double legacy = 0;
+    double nested = 0;
+    std::size_t found = 0;
+    {
+        Vector<Vector<int>> matrix;
+        matrix.reserve( n );
+        for( std::size_t i = 0; i < n; ++i ) {
+            Vector<int> row;
+            row.reserve( n );
+            for( std::size_t j = 0; j < n; ++j ) {
+                row.push_back( luckyElement( i, j, n ) );
+            }
+            matrix.push_back( std::move( row ) );
+        }
+        legacy = secondsFor( [&] { found += legacyLuckyNumbers( matrix ).getSize(); } );
+        nested = secondsFor( [&] { found += findLuckyNumbers( matrix ).getSize(); } );
+    }
+
+    Matrix<int> matrix( n, n );
+    for( std::size_t i = 0; i < n; ++i ) {
+        for( std::size_t j = 0; j < n; ++j ) {
+            matrix( i, j ) = luckyElement( i, j, n );
+        }
+    }
+    const double contiguous = secondsFor( [&] { found += findLuckyNumbers( matrix ).getSize(); } );
+
+    sink += found;
+    std::printf( "lucky     %zu x %zu: legacy %.3f s, Vector<Vector<int>> %.3f s, Matrix %.3f s (%zu found)\n",
+                 n, n, legacy, nested, contiguous, found );
+}
+
+int main( int argc, char** argv )
+{
+    const std::string only = argc > 1 ? argv[1] : "";
+    const std::size_t size = argc > 2 ? std::strtoull( argv[2], nullptr, 10 ) : 0;
+    auto wants = [&]( const char* name ) { return only.empty() || only == name; };
+
+    if( wants( "growth" ) ) {
+        benchGrowth( size != 0 ? size : 1000000 );
+    }
+    if( wants( "small" ) ) {
+        benchSmall( size != 0 ? size : 10000000 );
+    }
+    if( wants( "product" ) ) {
+        benchProduct( size != 0 ? size : 100000000 );
+    }
+    if( wants( "lucky" ) ) {
+        benchLucky( size != 0 ? size : 20000 );
+    }
+
+    return sink == 0 ? 1 : 0;
+}